@@ -0,0 +1,979 @@
+// bench.c - Headless benchmark suite for the libtiny3d rendering pipeline
+//
+// Runs micro-benchmarks for the math, canvas and lighting primitives plus a
+// few macro scenes, and reports the results as JSON (ns/op and lines/s or
+// frames/s where meaningful). Nothing is printed per frame and no frames are
+// kept on disk, so timings reflect the pipeline rather than console I/O.
+//
+// Usage: bench.exe [--filter <substring>] [--min-time <seconds>] [--repeat <n>]
+//                  [--out <file.json>] [--baseline <file.json> [--threshold <percent>]]
+//
+// With --baseline the results are compared against a previous run; the program
+// exits with status 1 when any benchmark is significantly slower (Welch t-test
+// at 95%) by more than the threshold (default 10%).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "canvas.h"
+#include "math3d.h"
+#include "renderer.h"
+#include "lighting.h"
+#include "mesh.h"
+#include "mesh_import.h"
+#include "geometry.h"
+#include "frame_ring.h"
+#include "animation.h"
+#include "profiler.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BENCH_CANVAS_SIZE 800
+#define BENCH_4K_WIDTH    3840
+#define BENCH_4K_HEIGHT   2160
+#define BENCH_POSTER_SIZE 32768   // sparse canvas: 4 GB if it were dense
+#define BENCH_INSTANCES   64
+#define BENCH_LINE_COUNT  1024
+#define BENCH_POINT_COUNT 4096
+#define BENCH_MANY_LIGHTS 256
+#define BENCH_ANIM_OBJECTS 4096
+#define BENCH_ANIM_FRAMES  120
+#define BENCH_GRID_SIDE    512     // grid mesh: 262144 vertices, 523264 edges
+
+// Kind of throughput reported next to ns/op
+typedef enum {
+    RATE_OPS,
+    RATE_LINES,
+    RATE_FRAMES
+} rate_kind_t;
+
+typedef void (*bench_fn)(long iterations);
+
+typedef struct {
+    const char* name;
+    bench_fn fn;
+    rate_kind_t rate;
+    int ops_per_iteration;  // e.g. lines drawn per iteration
+} bench_case_t;
+
+// Shared fixtures (built once in bench_setup)
+static canvas_t* g_canvas;
+static canvas_t* g_canvas_4k;
+static canvas_t* g_canvas_4k_blocked;             // same size, blocked layout
+static canvas_t* g_poster;                       // sparse, same lines in its top-left corner
+static geometry_t* g_ball;
+static mesh_t* g_ball_mesh;                      // same ball in SoA form
+static float g_ball_intensity[90];
+static light_t g_many_lights[BENCH_MANY_LIGHTS];      // ranged point lights over the instance grid
+static light_t g_many_unbounded[BENCH_MANY_LIGHTS];   // same lights without a range
+static affine_t g_grid_models[BENCH_INSTANCES];       // 8x8 grid, 4 units apart
+static vec3f_t g_ball_points[60];
+static vec4_t g_ball_clip[60];
+static mat4_t g_proj;
+static mat4_t g_view;
+static light_t g_lights[3];
+static mat4_t g_instance_m[BENCH_INSTANCES];     // per-instance model (translate * rotate)
+static affine_t g_instance_a[BENCH_INSTANCES];   // same transforms as affine_t
+static float g_lines[BENCH_LINE_COUNT][4];
+static float g_lines_4k[BENCH_LINE_COUNT][4];          // same distribution over the 4K canvas
+static float g_points[BENCH_POINT_COUNT][2];
+static animation_path_t g_anim_paths[BENCH_ANIM_OBJECTS];      // random orbits, 4 s each
+static vec3f_t g_anim_spins[BENCH_ANIM_OBJECTS];
+static animation_track_t* g_anim_tracks[BENCH_ANIM_OBJECTS];   // same motion baked at 30 fps
+static animation_timeline_t* g_anim_timelines[BENCH_ANIM_OBJECTS]; // 16 random keys over 4 s
+static affine_t g_anim_models[BENCH_ANIM_OBJECTS];
+static animation_spline_t* g_anim_spline;                      // 16 joined segments
+static geometry_t* g_grid;                                     // large mesh source arrays
+static const char* g_grid_file = "bench_mesh.t3m";
+static const char* g_grid_obj = "bench_mesh.obj";              // same grid as quad faces
+static const char* g_grid_ply = "bench_mesh.ply";              // binary little-endian
+static frame_ring_t* g_ring;                                   // shared-memory frame sink
+static frame_ring_t* g_ring_reader;                            // its consumer, in-process
+
+// Keeps results observable so the compiler cannot drop the work
+static volatile float g_sink;
+
+// Deterministic LCG so every run benchmarks the same workload
+static unsigned int g_seed = 12345u;
+static float bench_randf(void) {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return (float)(g_seed >> 8) / 16777216.0f;
+}
+
+// --- Fixtures ---
+
+// Grid as (side-1)^2 quads, so the importers see every inner edge twice
+static int bench_write_grid_files(void) {
+    const int side = BENCH_GRID_SIDE;
+    FILE* obj = fopen(g_grid_obj, "wb");
+    FILE* ply = fopen(g_grid_ply, "wb");
+    int ok = obj && ply;
+    if (ok) {
+        fprintf(ply, "ply\nformat binary_little_endian 1.0\nelement vertex %d\nproperty float x\n"
+                     "property float y\nproperty float z\nelement face %d\n"
+                     "property list uchar int vertex_indices\nend_header\n",
+                g_grid->vert_count, (side - 1) * (side - 1));
+        for (int v = 0; v < g_grid->vert_count; v++) {
+            vec3_t p = g_grid->verts[v];
+            float xyz[3] = { p.x, p.y, p.z };
+            fprintf(obj, "v %.6f %.6f %.6f\n", xyz[0], xyz[1], xyz[2]);
+            fwrite(xyz, sizeof(float), 3, ply);
+        }
+        unsigned char corners = 4;
+        for (int y = 0; y + 1 < side; y++) {
+            for (int x = 0; x + 1 < side; x++) {
+                int v = y * side + x;
+                int quad[4] = { v, v + 1, v + side + 1, v + side };
+                fprintf(obj, "f %d %d %d %d\n", quad[0] + 1, quad[1] + 1, quad[2] + 1, quad[3] + 1);
+                fwrite(&corners, 1, 1, ply);
+                fwrite(quad, sizeof(int), 4, ply);
+            }
+        }
+    }
+    if (obj && fclose(obj) != 0) ok = 0;
+    if (ply && fclose(ply) != 0) ok = 0;
+    return ok;
+}
+
+static int bench_setup(void) {
+    g_canvas = canvas_create(BENCH_CANVAS_SIZE, BENCH_CANVAS_SIZE);
+    g_canvas_4k = canvas_create(BENCH_4K_WIDTH, BENCH_4K_HEIGHT);
+    g_canvas_4k_blocked = canvas_create_blocked(BENCH_4K_WIDTH, BENCH_4K_HEIGHT);
+    g_poster = canvas_create_sparse(BENCH_POSTER_SIZE, BENCH_POSTER_SIZE);
+    if (!g_canvas || !g_canvas_4k || !g_canvas_4k_blocked || !g_poster) {
+        fprintf(stderr, "bench: failed to create canvases\n");
+        return 0;
+    }
+
+    // Without POSIX shared memory the ring case measures nothing
+    g_ring = frame_ring_create("/t3d_bench_ring", BENCH_CANVAS_SIZE, BENCH_CANVAS_SIZE, 8);
+    g_ring_reader = g_ring ? frame_ring_open("/t3d_bench_ring") : NULL;
+
+    g_ball = geometry_truncated_icosphere(0);
+    if (!g_ball || g_ball->vert_count != 60 || g_ball->edge_count != 90) {
+        fprintf(stderr, "bench: bad soccer ball\n");
+        return 0;
+    }
+    // Unit radius, as the ball has always been benchmarked at
+    float ball_scale = 1.0f / sqrtf(g_ball->verts[0].x * g_ball->verts[0].x + g_ball->verts[0].y * g_ball->verts[0].y +
+                                    g_ball->verts[0].z * g_ball->verts[0].z);
+    for (int i = 0; i < g_ball->vert_count; i++) {
+        vec3_t p = g_ball->verts[i];
+        g_ball->verts[i] = vec3_from_cartesian(p.x * ball_scale, p.y * ball_scale, p.z * ball_scale);
+    }
+
+    for (int i = 0; i < g_ball->vert_count; i++) {
+        g_ball_points[i] = vec3f_from_vec3(g_ball->verts[i]);
+    }
+    g_ball_mesh = mesh_from_vec3(g_ball->verts, g_ball->vert_count, g_ball->edges, g_ball->edge_count);
+    if (!g_ball_mesh) {
+        fprintf(stderr, "bench: failed to create mesh\n");
+        return 0;
+    }
+
+    g_proj = mat4_frustum(-2.5f, 2.5f, -2.0f, 2.0f, 3.0f, 30.0f);
+    g_view = mat4_translate(0.0f, 0.0f, -10.0f);
+
+    for (int i = 0; i < BENCH_INSTANCES; i++) {
+        float tx = bench_randf() * 8.0f - 4.0f, ty = bench_randf() * 6.0f - 3.0f;
+        float rx = bench_randf() * 6.0f, ry = bench_randf() * 6.0f, rz = bench_randf() * 6.0f;
+        g_instance_m[i] = mat4_multiply(mat4_translate(tx, ty, 0.0f), mat4_rotate_xyz(rx, ry, rz));
+        g_instance_a[i] = affine_multiply(affine_translate(tx, ty, 0.0f), affine_rotate_xyz(rx, ry, rz));
+    }
+
+    vec3_t white = vec3_from_cartesian(1.0f, 1.0f, 1.0f);
+    for (int i = 0; i < BENCH_INSTANCES; i++) {
+        g_grid_models[i] = affine_multiply(affine_translate((i % 8) * 4.0f, (i / 8) * 4.0f, 0.0f),
+                                           affine_rotate_xyz(i * 0.3f, i * 0.7f, 0.0f));
+    }
+    for (int i = 0; i < BENCH_MANY_LIGHTS; i++) {
+        vec3_t p = vec3_from_cartesian(bench_randf() * 32.0f - 2.0f, bench_randf() * 32.0f - 2.0f,
+                                       bench_randf() * 6.0f - 3.0f);
+        g_many_lights[i] = light_create_ranged(p, white, 0.2f, 3.0f);
+        g_many_unbounded[i] = light_create(p, white, 0.2f);
+    }
+
+    g_lights[0] = light_create(vec3_from_cartesian(0.0f, 0.0f, -10.0f), white, 1.0f);
+    g_lights[1] = light_create(vec3_from_cartesian(5.0f, 5.0f, -5.0f), white, 0.5f);
+    g_lights[2] = light_create(vec3_from_cartesian(-5.0f, 2.0f, -8.0f), white, 0.25f);
+
+    // Random lines of roughly 20-200 px at arbitrary orientation
+    for (int i = 0; i < BENCH_LINE_COUNT; i++) {
+        float cx = 100.0f + bench_randf() * (BENCH_CANVAS_SIZE - 200);
+        float cy = 100.0f + bench_randf() * (BENCH_CANVAS_SIZE - 200);
+        float angle = bench_randf() * 2.0f * (float)M_PI;
+        float half = 10.0f + bench_randf() * 90.0f;
+        g_lines[i][0] = cx - cosf(angle) * half;
+        g_lines[i][1] = cy - sinf(angle) * half;
+        g_lines[i][2] = cx + cosf(angle) * half;
+        g_lines[i][3] = cy + sinf(angle) * half;
+    }
+    for (int i = 0; i < BENCH_LINE_COUNT; i++) {
+        float cx = 100.0f + bench_randf() * (BENCH_4K_WIDTH - 200);
+        float cy = 100.0f + bench_randf() * (BENCH_4K_HEIGHT - 200);
+        float angle = bench_randf() * 2.0f * (float)M_PI;
+        float half = 10.0f + bench_randf() * 90.0f;
+        g_lines_4k[i][0] = cx - cosf(angle) * half;
+        g_lines_4k[i][1] = cy - sinf(angle) * half;
+        g_lines_4k[i][2] = cx + cosf(angle) * half;
+        g_lines_4k[i][3] = cy + sinf(angle) * half;
+    }
+    for (int i = 0; i < BENCH_POINT_COUNT; i++) {
+        g_points[i][0] = bench_randf() * BENCH_CANVAS_SIZE;
+        g_points[i][1] = bench_randf() * BENCH_CANVAS_SIZE;
+    }
+
+    // Large grid mesh, also written as a binary mesh file for the load benchmark
+    g_grid = geometry_grid(BENCH_GRID_SIDE - 1, BENCH_GRID_SIDE - 1, 0.01f);
+    if (!g_grid) {
+        fprintf(stderr, "bench: out of memory\n");
+        return 0;
+    }
+    for (int v = 0; v < g_grid->vert_count; v++) {
+        int x = v % BENCH_GRID_SIDE, y = v / BENCH_GRID_SIDE;
+        g_grid->verts[v] = vec3_from_cartesian(g_grid->verts[v].x, g_grid->verts[v].y, sinf(x * 0.1f) * cosf(y * 0.1f));
+    }
+    mesh_t* grid_mesh = mesh_from_vec3(g_grid->verts, g_grid->vert_count, g_grid->edges, g_grid->edge_count);
+    if (!grid_mesh || mesh_save(grid_mesh, g_grid_file) != 0) {
+        fprintf(stderr, "bench: failed to write %s\n", g_grid_file);
+        mesh_destroy(grid_mesh);
+        return 0;
+    }
+    mesh_destroy(grid_mesh);
+    if (!bench_write_grid_files()) {
+        fprintf(stderr, "bench: failed to write %s / %s\n", g_grid_obj, g_grid_ply);
+        return 0;
+    }
+
+    vec3_t spline_points[3 * 16 + 1];
+    for (int i = 0; i < 3 * 16 + 1; i++) {
+        spline_points[i] = vec3_from_cartesian(i * 0.5f, bench_randf() * 4.0f - 2.0f, bench_randf() * 4.0f - 2.0f);
+    }
+    g_anim_spline = spline_create(spline_points, 16, 8.0f);
+    if (!g_anim_spline) {
+        fprintf(stderr, "bench: failed to create spline\n");
+        return 0;
+    }
+
+    for (int i = 0; i < BENCH_ANIM_OBJECTS; i++) {
+        vec3_t c[4];
+        for (int k = 0; k < 4; k++) {
+            c[k] = vec3_from_cartesian(bench_randf() * 8.0f - 4.0f, bench_randf() * 8.0f - 4.0f,
+                                       bench_randf() * 8.0f - 4.0f);
+        }
+        g_anim_paths[i] = path_create(c[0], c[1], c[2], c[3], 4.0f);
+        g_anim_spins[i] = vec3f_make(bench_randf() * 3.0f, bench_randf() * 3.0f, bench_randf() * 3.0f);
+        g_anim_tracks[i] = track_bake(&g_anim_paths[i], g_anim_spins[i], 30.0f, BENCH_ANIM_FRAMES);
+
+        animation_keyframe_t keys[16];
+        for (int k = 0; k < 16; k++) {
+            vec3_t p = vec3_from_cartesian(bench_randf() * 8.0f - 4.0f, bench_randf() * 8.0f - 4.0f, bench_randf() * 8.0f - 4.0f);
+            vec3_t rot = vec3_from_cartesian(bench_randf() * 6.0f, bench_randf() * 6.0f, bench_randf() * 6.0f);
+            keys[k] = keyframe_create(p, rot, vec3_from_cartesian(1.0f, 1.0f, 1.0f), k * (4.0f / 15.0f));
+        }
+        g_anim_timelines[i] = timeline_create(keys, 16);
+        if (!g_anim_tracks[i] || !g_anim_timelines[i]) {
+            fprintf(stderr, "bench: failed to build animation tracks\n");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void bench_teardown(void) {
+    canvas_destroy(g_canvas);
+    canvas_destroy(g_canvas_4k);
+    canvas_destroy(g_canvas_4k_blocked);
+    canvas_destroy(g_poster);
+    geometry_destroy(g_ball);
+    frame_ring_close(g_ring_reader);
+    frame_ring_close(g_ring);
+    mesh_destroy(g_ball_mesh);
+    for (int i = 0; i < BENCH_ANIM_OBJECTS; i++) {
+        track_destroy(g_anim_tracks[i]);
+        timeline_destroy(g_anim_timelines[i]);
+    }
+    spline_destroy(g_anim_spline);
+    geometry_destroy(g_grid);
+    remove(g_grid_file);
+    remove(g_grid_obj);
+    remove(g_grid_ply);
+}
+
+// --- Micro-benchmarks ---
+
+static void bench_mat4_multiply(long iterations) {
+    mat4_t acc = mat4_rotate_xyz(0.1f, 0.2f, 0.3f);
+    mat4_t step = mat4_rotate_xyz(0.01f, 0.02f, 0.03f);
+    for (long i = 0; i < iterations; i++) {
+        acc = mat4_multiply(step, acc);
+    }
+    g_sink = acc.m[0];
+}
+
+static void bench_project_vertex(long iterations) {
+    mat4_t mvp = mat4_multiply(g_proj, g_view);
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        vec3_t p = project_vertex(g_ball->verts[i % g_ball->vert_count], mvp,
+                                  BENCH_CANVAS_SIZE, BENCH_CANVAS_SIZE);
+        sum += p.x;
+    }
+    g_sink = sum;
+}
+
+static void bench_transform_points(long iterations) {
+    mat4_t mvp = mat4_multiply(g_proj, g_view);
+    for (long i = 0; i < iterations; i++) {
+        mat4_transform_points(&mvp, g_ball_points, g_ball_clip, 60);
+    }
+    g_sink = g_ball_clip[7].x;
+}
+
+// Compose per-instance MVPs: full 4x4 chain vs affine model-view + one projection step
+static void bench_instance_mvp_mat4(long iterations) {
+    mat4_t spin = mat4_rotate_xyz(0.0f, 0.01f, 0.0f);
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        for (int k = 0; k < BENCH_INSTANCES; k++) {
+            mat4_t model, model_view, mvp;
+            mat4_multiply_into(&model, &g_instance_m[k], &spin);
+            mat4_multiply_into(&model_view, &g_view, &model);
+            mat4_multiply_into(&mvp, &g_proj, &model_view);
+            sum += mvp.m[12];
+        }
+    }
+    g_sink = sum;
+}
+
+static void bench_instance_mvp_affine(long iterations) {
+    affine_t spin = affine_rotate_xyz(0.0f, 0.01f, 0.0f);
+    affine_t view = affine_translate(0.0f, 0.0f, -10.0f);
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        for (int k = 0; k < BENCH_INSTANCES; k++) {
+            affine_t model, model_view;
+            mat4_t mvp;
+            affine_multiply_into(&model, &g_instance_a[k], &spin);
+            affine_multiply_into(&model_view, &view, &model);
+            mat4_multiply_affine(&mvp, &g_proj, &model_view);
+            sum += mvp.m[12];
+        }
+    }
+    g_sink = sum;
+}
+
+static void bench_quat_slerp_to_mat4(long iterations) {
+    quat_t a = quat_from_axis_angle(vec3f_make(0.0f, 1.0f, 0.0f), 0.2f);
+    quat_t b = quat_from_euler_xyz(0.4f, -1.1f, 0.7f);
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        mat4_t m = quat_to_mat4(quat_slerp(a, b, (float)(i & 1023) * (1.0f / 1023.0f)));
+        sum += m.m[0];
+    }
+    g_sink = sum;
+}
+
+// Model transforms of every animated object for one frame: live evaluation vs baked tracks
+static void bench_animate_eval(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        float time = (float)(i % BENCH_ANIM_FRAMES) * (1.0f / 30.0f);
+        for (int k = 0; k < BENCH_ANIM_OBJECTS; k++) {
+            vec3_t p = path_evaluate(&g_anim_paths[k], time);
+            vec3f_t s = g_anim_spins[k];
+            affine_t model = affine_multiply(affine_translate(p.x, p.y, p.z),
+                                             affine_rotate_xyz(s.x * time, s.y * time, s.z * time));
+            sum += model.m[3] + model.m[0];
+        }
+    }
+    g_sink = sum;
+}
+
+static void bench_animate_baked(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        int frame = (int)(i % BENCH_ANIM_FRAMES);
+        for (int k = 0; k < BENCH_ANIM_OBJECTS; k++) {
+            affine_t model = track_frame(g_anim_tracks[k], frame);
+            sum += model.m[3] + model.m[0];
+        }
+    }
+    g_sink = sum;
+}
+
+static void bench_animate_timeline(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        float time = (float)(i % BENCH_ANIM_FRAMES) * (1.0f / 30.0f);
+        timelines_evaluate(g_anim_timelines, BENCH_ANIM_OBJECTS, time, g_anim_models);
+    }
+    g_sink = g_anim_models[7].m[3];
+}
+
+// Raw eased Bezier vs constant-speed sampling through the arc-length tables
+static void bench_path_evaluate(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        sum += path_evaluate(&g_anim_paths[i & 1023], (float)(i & 4095) * 0.001f).x;
+    }
+    g_sink = sum;
+}
+
+static void bench_path_evaluate_uniform(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        sum += path_evaluate_uniform(&g_anim_paths[i & 1023], (float)(i & 4095) * 0.001f).x;
+    }
+    g_sink = sum;
+}
+
+static void bench_spline_evaluate_uniform(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        sum += spline_evaluate_uniform(g_anim_spline, (float)(i & 4095) * 0.002f).x;
+    }
+    g_sink = sum;
+}
+
+// One pass over the data the lighting kernels read
+static float bench_touch_mesh(const mesh_t* mesh) {
+    float sum = 0.0f;
+    for (int i = 0; i < mesh->vert_count; i += 16) sum += mesh->px[i] + mesh->py[i] + mesh->pz[i];
+    for (int i = 0; i < mesh->edge_count; i += 16) {
+        sum += (float)mesh->edges[i][1] + mesh->mid_x[i] + mesh->mid_y[i] + mesh->mid_z[i] +
+               mesh->normal_x[i] + mesh->normal_y[i] + mesh->normal_z[i];
+    }
+    return sum;
+}
+
+// First frame of a large mesh: build from arrays vs load the binary file,
+// each drawn straight from the mesh with render_wireframe_mesh
+static void bench_draw_grid_mesh(const mesh_t* mesh) {
+    canvas_clear(g_canvas);
+    render_wireframe_mesh(g_canvas, mesh, mat4_multiply(g_proj, g_view));
+}
+
+static void bench_mesh_build(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        mesh_t* mesh = mesh_from_vec3(g_grid->verts, g_grid->vert_count, g_grid->edges, g_grid->edge_count);
+        if (!mesh) continue;
+        bench_draw_grid_mesh(mesh);
+        mesh_destroy(mesh);
+    }
+}
+
+static void bench_mesh_load(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        mesh_t* mesh = mesh_load(g_grid_file);
+        if (!mesh) continue;
+        bench_draw_grid_mesh(mesh);
+        mesh_destroy(mesh);
+    }
+}
+
+static void bench_icosphere(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        geometry_t* sphere = geometry_icosphere(6);
+        if (!sphere) continue;
+        sum += sphere->verts[sphere->vert_count - 1].x + (float)sphere->edges[sphere->edge_count - 1][1];
+        geometry_destroy(sphere);
+    }
+    g_sink = sum;
+}
+
+static void bench_import(long iterations, const char* filename) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        mesh_t* mesh = mesh_import(filename);
+        if (!mesh) continue;
+        sum += bench_touch_mesh(mesh);
+        mesh_destroy(mesh);
+    }
+    g_sink = sum;
+}
+
+static void bench_import_obj(long iterations) { bench_import(iterations, g_grid_obj); }
+static void bench_import_ply(long iterations) { bench_import(iterations, g_grid_ply); }
+
+static void bench_draw_lines(canvas_t* canvas, float (*lines)[4], long iterations, float thickness) {
+    for (long i = 0; i < iterations; i++) {
+        const float* l = lines[i % BENCH_LINE_COUNT];
+        draw_line_f(canvas, l[0], l[1], l[2], l[3], thickness);
+    }
+}
+
+static void bench_draw_line_t05(long iterations) { bench_draw_lines(g_canvas, g_lines, iterations, 0.5f); }
+static void bench_draw_line_t15(long iterations) { bench_draw_lines(g_canvas, g_lines, iterations, 1.5f); }
+static void bench_draw_line_t35(long iterations) { bench_draw_lines(g_canvas, g_lines, iterations, 3.5f); }
+static void bench_draw_line_sparse(long iterations) { bench_draw_lines(g_poster, g_lines, iterations, 1.5f); }
+static void bench_draw_line_4k(long iterations) { bench_draw_lines(g_canvas_4k, g_lines_4k, iterations, 1.5f); }
+static void bench_draw_line_4k_blocked(long iterations) {
+    bench_draw_lines(g_canvas_4k_blocked, g_lines_4k, iterations, 1.5f);
+}
+
+static void bench_set_pixel_f(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        const float* p = g_points[i % BENCH_POINT_COUNT];
+        set_pixel_f(g_canvas, p[0], p[1], 0.25f);
+    }
+}
+
+static void bench_canvas_clear(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        canvas_clear(g_canvas);
+    }
+}
+
+static void bench_canvas_save_pgm(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        canvas_save_pgm(g_canvas, "bench_frame.pgm");
+    }
+    remove("bench_frame.pgm");
+}
+
+// Publish to the shared-memory ring and hand the slot straight back
+static void bench_frame_ring_publish(long iterations) {
+    if (!g_ring_reader) return;
+    unsigned sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        frame_ring_publish(g_ring, g_canvas, (int)i);
+        const uint8_t* pixels = frame_ring_acquire(g_ring_reader, NULL);
+        if (pixels) sum += pixels[i & 1023];
+        frame_ring_release(g_ring_reader);
+    }
+    g_sink = (float)sum;
+}
+
+static void bench_edge_lighting(long iterations) {
+    float sum = 0.0f;
+    for (long i = 0; i < iterations; i++) {
+        const int* e = g_ball->edges[i % g_ball->edge_count];
+        sum += calculate_edge_lighting(g_ball->verts[e[0]], g_ball->verts[e[1]], g_lights, 3);
+    }
+    g_sink = sum;
+}
+
+static void bench_edges_lighting(long iterations) {
+    for (long i = 0; i < iterations; i++) {
+        calculate_edges_lighting(g_ball_mesh, g_lights, 3, g_ball_intensity);
+    }
+    g_sink = g_ball_intensity[17];
+}
+
+static void bench_edges_lighting_model(long iterations) {
+    affine_t model = affine_multiply(affine_translate(0.5f, -1.0f, 2.0f), affine_rotate_xyz(0.3f, 1.1f, -0.4f));
+    for (long i = 0; i < iterations; i++) {
+        calculate_edges_lighting_model(g_ball_mesh, &model, g_lights, 3, g_ball_intensity);
+    }
+    g_sink = g_ball_intensity[17];
+}
+
+// Light the 8x8 instance grid against all of the many-light set
+static void bench_many_lights(long iterations, const light_t* lights) {
+    for (long i = 0; i < iterations; i++) {
+        for (int k = 0; k < BENCH_INSTANCES; k++) {
+            calculate_edges_lighting_model(g_ball_mesh, &g_grid_models[k], lights, BENCH_MANY_LIGHTS,
+                                           g_ball_intensity);
+        }
+    }
+    g_sink = g_ball_intensity[17];
+}
+
+static void bench_many_lights_ranged(long iterations) { bench_many_lights(iterations, g_many_lights); }
+static void bench_many_lights_unbounded(long iterations) { bench_many_lights(iterations, g_many_unbounded); }
+
+// --- Macro scenes ---
+
+// Lit wireframe pass used by the lighting test: project, light, draw
+static void bench_draw_lit_instance(canvas_t* canvas, mat4_t model, vec3_t* scratch) {
+    mat4_t mvp = mat4_multiply(g_proj, mat4_multiply(g_view, model));
+    for (int i = 0; i < g_ball->vert_count; i++) {
+        scratch[i] = project_vertex(g_ball->verts[i], mvp, canvas->width, canvas->height);
+    }
+    calculate_edges_lighting(g_ball_mesh, g_lights, 1, g_ball_intensity);
+    for (int i = 0; i < g_ball->edge_count; i++) {
+        int i0 = g_ball->edges[i][0];
+        int i1 = g_ball->edges[i][1];
+        float thickness = 0.5f + 3.0f * g_ball_intensity[i];
+        draw_line_f(canvas, scratch[i0].x, scratch[i0].y, scratch[i1].x, scratch[i1].y, thickness);
+    }
+}
+
+static mat4_t bench_ball_mvp(long frame) {
+    float time = frame / 30.0f;
+    mat4_t model = mat4_multiply(mat4_translate(0.0f, 0.0f, 3.0f),
+                                 mat4_rotate_xyz(time * 2.0f, time * 1.5f, time));
+    return mat4_multiply(g_proj, mat4_multiply(g_view, model));
+}
+
+static void bench_scene_soccer_ball(long iterations) {
+    for (long frame = 0; frame < iterations; frame++) {
+        canvas_clear(g_canvas);
+        mat4_t mvp = bench_ball_mvp(frame);
+        render_wireframe(g_canvas, g_ball->verts, g_ball->vert_count, g_ball->edges, g_ball->edge_count, mvp);
+    }
+}
+
+static void bench_scene_ball_4k(long iterations) {
+    for (long frame = 0; frame < iterations; frame++) {
+        canvas_clear(g_canvas_4k);
+        mat4_t mvp = bench_ball_mvp(frame);
+        render_wireframe(g_canvas_4k, g_ball->verts, g_ball->vert_count, g_ball->edges, g_ball->edge_count, mvp);
+    }
+}
+
+// Stands in for the writer: reads one pixel of each band
+static int bench_take_strip(const canvas_t* strip, int rows, void* user) {
+    *(float*)user += strip->pixels[rows - 1][strip->width / 2];
+    return 0;
+}
+
+static void bench_scene_ball_4k_strips(long iterations) {
+    float sum = 0.0f;
+    for (long frame = 0; frame < iterations; frame++) {
+        mat4_t mvp = bench_ball_mvp(frame);
+        render_wireframe_strips(BENCH_4K_WIDTH, BENCH_4K_HEIGHT, 64, g_ball->verts, g_ball->vert_count,
+                                g_ball->edges, g_ball->edge_count, mvp, bench_take_strip, &sum);
+    }
+    g_sink = sum;
+}
+
+static void bench_render_instances(canvas_t* canvas, long iterations, int instances) {
+    vec3_t scratch[60];
+    int side = (int)ceilf(sqrtf((float)instances));
+    for (long frame = 0; frame < iterations; frame++) {
+        float time = frame / 30.0f;
+        canvas_clear(canvas);
+        for (int n = 0; n < instances; n++) {
+            // Spread the instances over the visible area at the view distance
+            float spacing = 14.0f / side;
+            float x = ((n % side) - (side - 1) * 0.5f) * spacing;
+            float y = ((n / side) - (side - 1) * 0.5f) * spacing * 0.8f;
+            float s = spacing * 0.4f;
+            mat4_t model = mat4_multiply(
+                mat4_translate(x, y, 0.0f),
+                mat4_multiply(mat4_rotate_xyz(time + n, time * 1.5f, time * 0.5f),
+                              mat4_scale(s, s, s)));
+            bench_draw_lit_instance(canvas, model, scratch);
+        }
+    }
+}
+
+static void bench_scene_instances(long iterations) {
+    bench_render_instances(g_canvas, iterations, BENCH_INSTANCES);
+}
+
+static void bench_scene_4k(long iterations) {
+    bench_render_instances(g_canvas_4k, iterations, 16);
+}
+
+static const bench_case_t g_cases[] = {
+    {"mat4_multiply",        bench_mat4_multiply,     RATE_OPS,    1},
+    {"project_vertex",       bench_project_vertex,    RATE_OPS,    1},
+    {"mat4_transform_points", bench_transform_points, RATE_OPS,    60},
+    {"instance_mvp_mat4",    bench_instance_mvp_mat4,   RATE_OPS,  BENCH_INSTANCES},
+    {"instance_mvp_affine",  bench_instance_mvp_affine, RATE_OPS,  BENCH_INSTANCES},
+    {"quat_slerp_to_mat4",   bench_quat_slerp_to_mat4, RATE_OPS,   1},
+    {"animate_4096_eval",    bench_animate_eval,      RATE_OPS,    BENCH_ANIM_OBJECTS},
+    {"animate_4096_baked",   bench_animate_baked,     RATE_OPS,    BENCH_ANIM_OBJECTS},
+    {"animate_4096_timeline", bench_animate_timeline, RATE_OPS,    BENCH_ANIM_OBJECTS},
+    {"path_evaluate",        bench_path_evaluate,     RATE_OPS,    1},
+    {"path_evaluate_uniform", bench_path_evaluate_uniform, RATE_OPS, 1},
+    {"spline_evaluate_uniform_16seg", bench_spline_evaluate_uniform, RATE_OPS, 1},
+    {"mesh_build_523k_edges", bench_mesh_build,       RATE_OPS,    1},
+    {"mesh_load_523k_edges", bench_mesh_load,         RATE_OPS,    1},
+    {"icosphere_6_123k_edges", bench_icosphere,       RATE_OPS,    1},
+    {"import_obj_523k_edges", bench_import_obj,       RATE_OPS,    1},
+    {"import_ply_523k_edges", bench_import_ply,       RATE_OPS,    1},
+    {"draw_line_f_t0.5",     bench_draw_line_t05,     RATE_LINES,  1},
+    {"draw_line_f_t1.5",     bench_draw_line_t15,     RATE_LINES,  1},
+    {"draw_line_f_t3.5",     bench_draw_line_t35,     RATE_LINES,  1},
+    {"draw_line_f_t1.5_sparse_32k", bench_draw_line_sparse, RATE_LINES, 1},
+    {"draw_line_f_t1.5_4k",  bench_draw_line_4k,      RATE_LINES,  1},
+    {"draw_line_f_t1.5_4k_blocked", bench_draw_line_4k_blocked, RATE_LINES, 1},
+    {"set_pixel_f",          bench_set_pixel_f,       RATE_OPS,    1},
+    {"canvas_clear_800",     bench_canvas_clear,      RATE_OPS,    1},
+    {"canvas_save_pgm_800",  bench_canvas_save_pgm,   RATE_OPS,    1},
+    {"frame_ring_publish_800", bench_frame_ring_publish, RATE_OPS, 1},
+    {"calculate_edge_lighting_3l", bench_edge_lighting, RATE_OPS,  1},
+    {"calculate_edges_lighting_3l", bench_edges_lighting, RATE_OPS, 90},
+    {"calculate_edges_lighting_model_3l", bench_edges_lighting_model, RATE_OPS, 90},
+    {"edges_lighting_256l_ranged",    bench_many_lights_ranged,    RATE_OPS, 90 * BENCH_INSTANCES},
+    {"edges_lighting_256l_unbounded", bench_many_lights_unbounded, RATE_OPS, 90 * BENCH_INSTANCES},
+    {"scene_soccer_ball",    bench_scene_soccer_ball, RATE_FRAMES, 1},
+    {"scene_soccer_ball_4k", bench_scene_ball_4k,     RATE_FRAMES, 1},
+    {"scene_soccer_ball_4k_strips_64", bench_scene_ball_4k_strips, RATE_FRAMES, 1},
+    {"scene_instances_64",   bench_scene_instances,   RATE_FRAMES, 1},
+    {"scene_4k_16",          bench_scene_4k,          RATE_FRAMES, 1},
+};
+
+// --- Harness ---
+
+#define BENCH_MAX_REPEAT 64
+
+// Timing statistics of one benchmark over its repeated samples
+typedef struct {
+    char name[64];
+    long iterations;
+    int samples;
+    double mean_ns;     // mean ns/op over samples
+    double stddev_ns;   // sample standard deviation of ns/op
+    double ci95_ns;     // half-width of the 95% confidence interval of the mean
+} bench_stats_t;
+
+// Grows the iteration count until one timed batch lasts at least min_time
+static long bench_calibrate(const bench_case_t* c, double min_time_s) {
+    long iterations = 1;
+
+    c->fn(1);  // warm-up: touch caches and lazily initialised state
+    for (;;) {
+        uint64_t start = profiler_now_ns();
+        c->fn(iterations);
+        double elapsed = (double)(profiler_now_ns() - start);
+        if (elapsed >= min_time_s * 1e9 || iterations >= (1L << 30)) break;
+
+        // Aim slightly past the target to avoid a long tail of short batches
+        double scale = (elapsed > 0.0) ? (min_time_s * 1e9 * 1.2) / elapsed : 100.0;
+        if (scale < 2.0) scale = 2.0;
+        if (scale > 100.0) scale = 100.0;
+        iterations = (long)(iterations * scale);
+    }
+    return iterations;
+}
+
+// Two-sided 95% Student-t critical value for the given degrees of freedom
+static double t_critical_95(double df) {
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1.0) return table[0];
+    if (df > 30.0) return 1.960;
+    return table[(int)df - 1];
+}
+
+// Times one batch of the calibrated size and returns ns/op
+static double bench_sample(const bench_case_t* c, long iterations) {
+    uint64_t start = profiler_now_ns();
+    c->fn(iterations);
+    double elapsed = (double)(profiler_now_ns() - start);
+    return elapsed / (double)iterations / c->ops_per_iteration;
+}
+
+// Mean, standard deviation and 95% confidence interval over the samples
+static void bench_summarise(bench_stats_t* stats, const double* samples, int count) {
+    double sum = 0.0;
+    for (int r = 0; r < count; r++) sum += samples[r];
+    stats->samples = count;
+    stats->mean_ns = sum / count;
+    stats->stddev_ns = 0.0;
+    stats->ci95_ns = 0.0;
+
+    if (count > 1) {
+        double sq = 0.0;
+        for (int r = 0; r < count; r++) {
+            double d = samples[r] - stats->mean_ns;
+            sq += d * d;
+        }
+        stats->stddev_ns = sqrt(sq / (count - 1));
+        stats->ci95_ns = t_critical_95(count - 1) * stats->stddev_ns / sqrt((double)count);
+    }
+}
+
+static const char* rate_key(rate_kind_t kind) {
+    switch (kind) {
+        case RATE_LINES:  return "lines_per_sec";
+        case RATE_FRAMES: return "frames_per_sec";
+        default:          return "ops_per_sec";
+    }
+}
+
+// Extracts a numeric field ("key": value) from one result line
+static int json_number(const char* line, const char* key, double* out) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* p = strstr(line, pattern);
+    if (!p) return 0;
+    *out = strtod(p + strlen(pattern), NULL);
+    return 1;
+}
+
+// Loads a results file written by this program (one benchmark per line)
+static int bench_load_baseline(const char* filename, bench_stats_t* out, int max_entries) {
+    FILE* file = fopen(filename, "r");
+    if (!file) return -1;
+
+    char line[512];
+    int count = 0;
+    while (count < max_entries && fgets(line, sizeof(line), file)) {
+        const char* name = strstr(line, "\"name\": \"");
+        if (!name) continue;
+        name += strlen("\"name\": \"");
+        const char* end = strchr(name, '"');
+        if (!end || end - name >= (int)sizeof(out[count].name)) continue;
+
+        bench_stats_t* s = &out[count];
+        memset(s, 0, sizeof(*s));
+        memcpy(s->name, name, end - name);
+        s->name[end - name] = '\0';
+
+        double value;
+        if (!json_number(line, "ns_per_op", &s->mean_ns)) continue;
+        if (json_number(line, "stddev_ns", &value)) s->stddev_ns = value;
+        s->samples = json_number(line, "samples", &value) ? (int)value : 1;
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+// Welch's t-test on the difference of means. A benchmark regresses when the
+// 95% confidence interval of (current - baseline) lies entirely above zero
+// and the slowdown exceeds threshold_pct.
+static int bench_is_regression(const bench_stats_t* base, const bench_stats_t* cur,
+                               double threshold_pct, double* out_delta_pct) {
+    double delta = cur->mean_ns - base->mean_ns;
+    *out_delta_pct = (base->mean_ns > 0.0) ? 100.0 * delta / base->mean_ns : 0.0;
+    if (*out_delta_pct <= threshold_pct) return 0;
+
+    double vb = (base->samples > 1) ? base->stddev_ns * base->stddev_ns / base->samples : 0.0;
+    double vc = (cur->samples > 1) ? cur->stddev_ns * cur->stddev_ns / cur->samples : 0.0;
+    double se = sqrt(vb + vc);
+    if (se == 0.0) return 1;  // single samples: only the threshold applies
+
+    // Welch–Satterthwaite degrees of freedom
+    double df_den = 0.0;
+    if (base->samples > 1) df_den += vb * vb / (base->samples - 1);
+    if (cur->samples > 1) df_den += vc * vc / (cur->samples - 1);
+    double df = (df_den > 0.0) ? (vb + vc) * (vb + vc) / df_den : 1.0;
+
+    return delta - t_critical_95(df) * se > 0.0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--filter <substring>] [--min-time <seconds>] [--repeat <n>]\n"
+            "          [--out <file.json>] [--baseline <file.json> [--threshold <percent>]]\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    const char* out_path = NULL;
+    const char* baseline_path = NULL;
+    double min_time = 0.25;
+    double threshold_pct = 10.0;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold_pct = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (min_time <= 0.0) min_time = 0.25;
+    if (repeat < 1) repeat = 1;
+    if (repeat > BENCH_MAX_REPEAT) repeat = BENCH_MAX_REPEAT;
+
+    int case_count = (int)(sizeof(g_cases) / sizeof(g_cases[0]));
+    bench_stats_t baseline[64];
+    int baseline_count = 0;
+    if (baseline_path) {
+        baseline_count = bench_load_baseline(baseline_path, baseline, 64);
+        if (baseline_count < 0) {
+            fprintf(stderr, "bench: cannot read baseline %s\n", baseline_path);
+            return 2;
+        }
+    }
+
+    if (!bench_setup()) return 1;
+
+    FILE* out = stdout;
+    if (out_path) {
+        out = fopen(out_path, "w");
+        if (!out) {
+            fprintf(stderr, "bench: cannot open %s\n", out_path);
+            bench_teardown();
+            return 1;
+        }
+    }
+
+    // Calibrate every selected case, then take the samples round-robin so
+    // that slow drift of the machine spreads over all benchmarks evenly
+    static bench_stats_t stats[sizeof(g_cases) / sizeof(g_cases[0])];
+    static double samples[sizeof(g_cases) / sizeof(g_cases[0])][BENCH_MAX_REPEAT];
+    int selected[sizeof(g_cases) / sizeof(g_cases[0])];
+    int selected_count = 0;
+    for (int i = 0; i < case_count; i++) {
+        if (filter && !strstr(g_cases[i].name, filter)) continue;
+        snprintf(stats[i].name, sizeof(stats[i].name), "%s", g_cases[i].name);
+        stats[i].iterations = bench_calibrate(&g_cases[i], min_time);
+        selected[selected_count++] = i;
+    }
+    for (int r = 0; r < repeat; r++) {
+        for (int k = 0; k < selected_count; k++) {
+            int i = selected[k];
+            samples[i][r] = bench_sample(&g_cases[i], stats[i].iterations);
+        }
+    }
+
+    fprintf(out, "{\n  \"min_time_s\": %.3f,\n  \"repeat\": %d,\n  \"benchmarks\": [", min_time, repeat);
+    int regressions = 0;
+    for (int k = 0; k < selected_count; k++) {
+        int i = selected[k];
+        const bench_case_t* c = &g_cases[i];
+        bench_summarise(&stats[i], samples[i], repeat);
+        double rate = (stats[i].mean_ns > 0.0) ? 1e9 / stats[i].mean_ns : 0.0;
+
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"iterations\": %ld, \"samples\": %d, "
+                     "\"ns_per_op\": %.3f, \"stddev_ns\": %.3f, \"ci95_ns\": %.3f, \"%s\": %.1f}",
+                k ? "," : "", c->name, stats[i].iterations, stats[i].samples,
+                stats[i].mean_ns, stats[i].stddev_ns, stats[i].ci95_ns, rate_key(c->rate), rate);
+
+        const bench_stats_t* base = NULL;
+        for (int b = 0; b < baseline_count; b++) {
+            if (strcmp(baseline[b].name, c->name) == 0) base = &baseline[b];
+        }
+
+        if (baseline_path && base) {
+            double delta_pct = 0.0;
+            int regressed = bench_is_regression(base, &stats[i], threshold_pct, &delta_pct);
+            regressions += regressed;
+            fprintf(stderr, "%-28s %14.1f ns/op  (baseline %12.1f, %+7.1f%%)%s\n",
+                    c->name, stats[i].mean_ns, base->mean_ns, delta_pct, regressed ? "  REGRESSION" : "");
+        } else if (baseline_path) {
+            fprintf(stderr, "%-28s %14.1f ns/op  (no baseline)\n", c->name, stats[i].mean_ns);
+        } else if (out != stdout) {
+            fprintf(stderr, "%-28s %14.1f ns/op  ±%.1f\n", c->name, stats[i].mean_ns, stats[i].ci95_ns);
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    bench_teardown();
+
+    if (regressions > 0) {
+        fprintf(stderr, "bench: %d benchmark(s) slower than baseline by more than %.1f%%\n",
+                regressions, threshold_pct);
+        return 1;
+    }
+    return 0;
+}
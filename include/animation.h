@@ -11,12 +11,30 @@ typedef struct {
     float time;
 } animation_keyframe_t;
 
+// Samples in a path's arc-length table
+#define PATH_ARC_SAMPLES 32
+
 // Animation path structure for Bezier curves
 typedef struct {
     vec3_t p0, p1, p2, p3;  // Control points
     float duration;         // Duration of the animation
+    float length;           // Arc length (filled by path_create)
+    float arc_table[PATH_ARC_SAMPLES + 1]; // Bezier t at uniform fractions of the length
+    int has_arc_table;      // Set by path_create; 0 means length and arc_table are unset
 } animation_path_t;
 
+// Chain of cubic Bezier segments sharing end points, with one arc-length
+// table over the whole spline
+typedef struct {
+    vec3_t* points;         // 3 * segment_count + 1 control points
+    int segment_count;
+    float duration;
+    float length;
+    int table_size;         // segment_count * PATH_ARC_SAMPLES
+    float* arc_table;       // segment + t at uniform fractions of the length
+    float* joints;          // length fraction at each segment start (segment_count + 1)
+} animation_spline_t;
+
 // Cubic Bezier curve evaluation
 vec3_t bezier(vec3_t p0, vec3_t p1, vec3_t p2, vec3_t p3, float t);
 
@@ -27,7 +45,21 @@ animation_keyframe_t keyframe_create(vec3_t position, vec3_t rotation, vec3_t sc
 animation_path_t path_create(vec3_t p0, vec3_t p1, vec3_t p2, vec3_t p3, float duration);
 
 // Evaluate animation path at given time
-vec3_t path_evaluate(animation_path_t path, float time);
+vec3_t path_evaluate(const animation_path_t* path, float time);
+
+// Point at fraction s of the path's arc length; apply easing to s for eased
+// constant-speed motion. Use path_create: a zero-initialized path with
+// has_arc_table == 0 is still correct but rebuilds the table on every call.
+vec3_t path_at_distance(const animation_path_t* path, float s);
+
+// Constant-speed evaluation, looping every duration like path_evaluate
+vec3_t path_evaluate_uniform(const animation_path_t* path, float time);
+
+// Spline from 3 * segment_count + 1 control points; NULL if segment_count < 1
+animation_spline_t* spline_create(const vec3_t* points, int segment_count, float duration);
+void spline_destroy(animation_spline_t* spline);
+vec3_t spline_at_distance(const animation_spline_t* spline, float s);
+vec3_t spline_evaluate_uniform(const animation_spline_t* spline, float time);
 
 // Smooth step function for easing
 float smooth_step(float t);
@@ -35,4 +67,55 @@ float smooth_step(float t);
 // Create a rotation animation around an axis
 vec3_t rotate_around_axis(vec3_t axis, float angle, float time, float duration);
 
+// Position/orientation track sampled once per frame at a fixed rate, so frame
+// loops index arrays instead of re-evaluating easing, Bezier and sin/cos
+typedef struct {
+    float fps;
+    int frame_count;
+    vec3f_t* positions;     // path position at frame / fps
+    quat_t* orientations;   // Euler XYZ rotation spin * (frame / fps)
+} animation_track_t;
+
+// Bake a track; path may be NULL (stays at the origin), spin is in radians/second
+animation_track_t* track_bake(const animation_path_t* path, vec3f_t spin, float fps, int frame_count);
+void track_destroy(animation_track_t* track);
+
+// Model transform at a time between baked frames (lerp/nlerp, clamped to the track)
+affine_t track_sample(const animation_track_t* track, float time);
+
+// Model transform of a baked frame (clamped to the track)
+static inline affine_t track_frame(const animation_track_t* track, int frame) {
+    if (frame < 0) frame = 0;
+    if (frame >= track->frame_count) frame = track->frame_count - 1;
+    return affine_from_quat(track->orientations[frame], track->positions[frame]);
+}
+
+// Keyframes of one object in structure-of-arrays form, one array per channel
+// component; rotation is Euler XYZ and interpolates linearly like the others
+typedef struct {
+    int key_count;
+    float* times;               // non-decreasing
+    float* pos_x;
+    float* pos_y;
+    float* pos_z;
+    float* rot_x;
+    float* rot_y;
+    float* rot_z;
+    float* scale_x;
+    float* scale_y;
+    float* scale_z;
+    int cursor;                 // segment found by the last lookup
+} animation_timeline_t;
+
+// Copy keyframes into a timeline; NULL if empty or not sorted by time
+animation_timeline_t* timeline_create(const animation_keyframe_t* keys, int key_count);
+void timeline_destroy(animation_timeline_t* timeline);
+
+// Interpolated channels at time (clamped to the first/last key). Lookups start
+// from the cached cursor, so monotonically increasing times cost O(1)
+void timeline_evaluate(animation_timeline_t* timeline, float time, vec3f_t* position, vec3f_t* rotation, vec3f_t* scale);
+
+// Model transforms (translate * rotate_xyz * scale) of many timelines at one time
+void timelines_evaluate(animation_timeline_t* const* timelines, int count, float time, affine_t* out);
+
 #endif // ANIMATION_H
\ No newline at end of file
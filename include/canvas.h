@@ -8,19 +8,61 @@
 #include <stdint.h>
 
 
+// Sparse canvases store the image as square tiles of CANVAS_TILE_SIZE pixels,
+// allocated the first time something is drawn into them
+#define CANVAS_TILE_SHIFT 6
+#define CANVAS_TILE_SIZE (1 << CANVAS_TILE_SHIFT)
+
+// Blocked canvases keep the image in one buffer of CANVAS_BLOCK_SIZE square
+// blocks (256 bytes each), so lines at any angle stay within few cache lines
+#define CANVAS_BLOCK_SHIFT 3
+#define CANVAS_BLOCK_SIZE (1 << CANVAS_BLOCK_SHIFT)
+
+// Row-major and blocked canvases carry a border of CANVAS_GUARD pixels on every side that
+// drawing may spill into and export ignores. draw_line_f clips each segment
+// once and then splats lines up to CANVAS_GUARD - 6 pixels thick without
+// per-pixel bounds checks.
+#define CANVAS_GUARD 16
+
 typedef struct {
     int width;
     int height;
-    float **pixels;  // 2D array of brightness values [0.0, 1.0]
+    int origin_y;    // image row held in row 0: nonzero for a strip of a taller image
+    float **pixels;  // 2D array of brightness values [0.0, 1.0]; NULL for sparse and blocked canvases
+    int guard;       // border width, 0 for sparse; pixels[y][x] is addressable for x, y in [-guard, size + guard)
+    float **tiles;   // sparse: tiles_x * tiles_y row-major tiles, NULL until touched
+    int tiles_x;
+    int tiles_y;
+    float *blocks;   // blocked: row-major blocks of row-major pixels, blocks_x per block row
+    int blocks_x;
 } canvas_t;
 
 // Function declarations
 canvas_t* canvas_create(int width, int height);
+// Same drawing API, but memory grows with the area drawn into rather than the
+// image size, so posters far larger than RAM can be rendered. Untouched tiles read as zero.
+canvas_t* canvas_create_sparse(int width, int height);
+// Dense canvas in the blocked layout: faster drawing of steep and diagonal
+// lines; rows are gathered only when the image is read out
+canvas_t* canvas_create_blocked(int width, int height);
 void canvas_destroy(canvas_t* canvas);
 void canvas_clear(canvas_t* canvas);
 void set_pixel_f(canvas_t* canvas, float x, float y, float intensity);
 void draw_line_f(canvas_t* canvas, float x0, float y0, float x1, float y1, float thickness);
-void canvas_save_pgm(canvas_t* canvas, const char* filename);
+int canvas_save_pgm(canvas_t* canvas, const char* filename);   // -1 if the file could not be written
+// Streaming P2 writer: emits the image one band of tile rows at a time without
+// materialising it. With release set, a sparse canvas frees each band once written.
+int canvas_write_pgm(canvas_t* canvas, FILE* file, int release);
+// For images produced strip by strip: the P2 header of the whole image, then
+// the first `rows` rows of each strip in turn
+void canvas_write_pgm_header(FILE* file, int width, int height);
+int canvas_write_pgm_rows(const canvas_t* canvas, FILE* file, int rows);
+
+float canvas_get_pixel(const canvas_t* canvas, int x, int y);  // image coordinates; 0 outside the canvas
+// Stored row y for reading: points into the canvas when rows are stored whole,
+// otherwise filled into scratch (width floats)
+const float* canvas_row(const canvas_t* canvas, int y, float* scratch);
+int canvas_tile_count(const canvas_t* canvas);  // tiles allocated so far (0 for dense canvases)
 void draw_circle(canvas_t* canvas, int center_x, int center_y, int radius, uint8_t intensity);
 
 #endif
\ No newline at end of file
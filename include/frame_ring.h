@@ -0,0 +1,93 @@
+// frame_ring.h - Shared-memory ring of finished frames for a local consumer process
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "canvas.h"
+
+#define FRAME_RING_VERSION 2
+#define FRAME_RING_NAME_MAX 64
+#define FRAME_RING_MAX_PRODUCERS 16
+
+// Shared layout: this header, then slot_count slots of slot_stride bytes, each
+// a frame_ring_slot_t followed by width * height 8-bit pixels (row-major, the
+// values a PGM would hold, clamped to 0-255). All fields are in host byte order.
+//
+// Index protocol (bounded multi-producer, single-consumer queue): slot i of
+// position p holds sequence p while free, p + 1 once published, and is handed
+// back as p + slot_count when the consumer releases it. Producers claim
+// positions by compare-and-swap on head; only the consumer moves tail.
+//
+// Processes that exit without detaching are found by pid: producers are listed
+// in producer_pids and a slot being filled names its writer, so the ring still
+// closes and the consumer skips the frame a dead producer never published.
+// Producers join and leave under an fcntl lock on the shared-memory object.
+typedef struct {
+    char magic[8];              // "T3DRING"
+    uint32_t version;           // stored last by the creator: the ring is ready
+    uint32_t width;
+    uint32_t height;
+    uint32_t slot_count;        // power of two
+    uint64_t slot_stride;       // bytes per slot, a multiple of 64
+    uint32_t producers;         // attached producers; the last to leave closes the ring
+    uint32_t consumer;          // pid of the attached consumer, 0 if none
+    uint32_t closed;            // set when no producer remains
+    uint8_t pad0[64 - 44];
+    uint32_t producer_pids[FRAME_RING_MAX_PRODUCERS];  // 0 for a free entry
+    uint64_t head;              // next position to claim (own cache line)
+    uint8_t pad1[56];
+    uint64_t tail;              // next position to read (own cache line)
+    uint8_t pad2[56];
+} frame_ring_header_t;
+
+typedef struct {
+    uint64_t sequence;
+    int32_t frame;              // absolute frame index
+    uint32_t writer;            // pid of the producer filling the slot, 0 otherwise
+    uint8_t pad[48];
+} frame_ring_slot_t;
+
+// One process's view of a ring
+typedef struct {
+    frame_ring_header_t* header;
+    size_t map_size;
+    int fd;                     // shared-memory object, kept open for locking
+    int producer;               // 1 if attached with frame_ring_create
+    int producer_entry;         // its index in producer_pids
+    uint64_t reading;           // consumer: position acquired and not yet released
+    int holding;
+    char name[FRAME_RING_NAME_MAX];
+} frame_ring_t;
+
+// Create the POSIX shared-memory object `name` ("/preview") with slot_count
+// frames of width x height, or attach to an existing ring of the same size,
+// so several shard processes can feed one consumer. A ring left closed, or
+// whose producers all died, is replaced. NULL on failure.
+frame_ring_t* frame_ring_create(const char* name, int width, int height, int slot_count);
+
+// Attach as the consumer (one at a time); NULL if the ring does not exist yet
+// or already has a consumer
+frame_ring_t* frame_ring_open(const char* name);
+
+// Detach. The last producer marks the ring closed and removes the name; the
+// consumer's mapping stays valid until it detaches too.
+void frame_ring_close(frame_ring_t* ring);
+
+// Convert the canvas straight into a free slot and publish it. With no consumer
+// attached the frame is dropped once the ring is full (1 is returned), so an
+// unwatched render never stalls; with one attached the call waits for a slot.
+// 0 when published, -1 if the canvas does not match the ring.
+int frame_ring_publish(frame_ring_t* ring, const canvas_t* canvas, int frame);
+
+// Consumer: pixels of the oldest published frame, read in place, or NULL if
+// none is ready. The slot stays reserved until frame_ring_release.
+const uint8_t* frame_ring_acquire(frame_ring_t* ring, int* frame);
+void frame_ring_release(frame_ring_t* ring);
+
+// Consumer: 1 once every producer has closed and no frame is left to read.
+// Also where dead producers are noticed: their registrations are dropped and
+// a slot one of them claimed but never published is skipped.
+int frame_ring_finished(frame_ring_t* ring);
+
+#endif // FRAME_RING_H
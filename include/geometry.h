@@ -0,0 +1,59 @@
+// geometry.h - Procedural wireframe solids: polyhedra, geodesic spheres, grids
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "math3d.h"
+
+// Deepest icosphere subdivision accepted (10 * 4^n + 2 vertices)
+#define GEOMETRY_MAX_SUBDIVISIONS 10
+
+// Vertex list and unique edges (each undirected edge once). Solids built from
+// triangles keep them, so they can be subdivided or truncated further.
+typedef struct {
+    vec3_t* verts;
+    int vert_count;
+    int (*edges)[2];
+    int edge_count;
+    int (*triangles)[3];    // NULL when the faces are not all triangles
+    int triangle_count;
+} geometry_t;
+
+// Regular tetrahedron with unit circumradius
+geometry_t* geometry_tetrahedron(void);
+
+// Cube with corners at (+-1, +-1, +-1)
+geometry_t* geometry_cube(void);
+
+// Geodesic sphere of unit radius: an icosahedron whose triangles are split in
+// four `subdivisions` times, new vertices pushed out to the sphere. Level n
+// keeps the vertices of level n - 1 as a prefix, so levels form a LOD chain.
+geometry_t* geometry_icosphere(int subdivisions);
+
+// Icosphere with every vertex cut off at 1/3 of each edge; level 0 is the
+// truncated icosahedron (soccer ball: 60 vertices, 90 edges)
+geometry_t* geometry_truncated_icosphere(int subdivisions);
+
+// (columns + 1) x (rows + 1) vertices `spacing` apart in the z = 0 plane,
+// centred on the origin, joined along rows and columns
+geometry_t* geometry_grid(int columns, int rows, float spacing);
+
+// Split each triangle of a solid in four through its edge midpoints, projected
+// onto the unit sphere. Linear time: midpoints are shared through an edge hash map.
+geometry_t* geometry_subdivide(const geometry_t* solid);
+
+// Cut every vertex of a triangle solid at fraction t (0 < t < 0.5) along its edges
+geometry_t* geometry_truncate(const geometry_t* solid, float t);
+
+void geometry_destroy(geometry_t* geometry);
+
+// Memoized versions: built on first use and shared until geometry_cache_clear.
+// An icosphere level is subdivided from the cached level below it, so walking a
+// LOD chain costs one subdivision per level. Not thread-safe; NULL on failure.
+const geometry_t* geometry_icosphere_cached(int subdivisions);
+const geometry_t* geometry_truncated_icosphere_cached(int subdivisions);
+const geometry_t* geometry_grid_cached(int columns, int rows, float spacing);
+
+// Free every memoized solid; pointers returned earlier become invalid
+void geometry_cache_clear(void);
+
+#endif // GEOMETRY_H
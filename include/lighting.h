@@ -2,19 +2,45 @@
 #define LIGHTING_H
 
 #include "math3d.h"
+#include "mesh.h"
 
 // Light structure
 typedef struct {
     vec3_t position;    // Light position in world space
     vec3_t color;       // Light color (RGB values 0-1)
     float intensity;    // Light intensity multiplier
+    float range;        // Influence radius; 0 means unbounded
 } light_t;
 
-// Create a new light
+// Create a new light (unbounded range)
 light_t light_create(vec3_t position, vec3_t color, float intensity);
 
+// Create a point light that only affects geometry within 'range'
+light_t light_create_ranged(vec3_t position, vec3_t color, float intensity, float range);
+
+// Copy to 'out' the lights that can affect a sphere: drops zero-intensity
+// lights and lights whose range does not reach it. Negative-intensity lights
+// darken and are kept. Returns the number kept.
+int lights_cull(const light_t* lights, int light_count, vec3f_t center, float radius, light_t* out);
+
 // Calculate lighting intensity for an edge using Lambert lighting
 float calculate_edge_lighting(vec3_t v0, vec3_t v1, light_t* lights, int light_count);
 
+// Same lighting for every edge of a mesh at once (SIMD across edges), writing
+// mesh->edge_count intensities to out_intensity. Uses the mesh's cached edge
+// midpoints and normals; lights must be in the mesh's coordinate space.
+void calculate_edges_lighting(const mesh_t* mesh, const light_t* lights, int light_count, float* out_intensity);
+
+// As above for a model-space mesh placed by 'model' (rigid; ranges are compared
+// in model space):
+// the lights are moved into model space once, so normals point away from the
+// object's own origin rather than the world origin.
+// Both batch calls first cull lights against the mesh's bounding sphere, and
+// skip ranged lights per group of edges that lie entirely out of range.
+// Every intensity is always written: edges come out unlit (0) if the model is
+// singular or the light staging cannot be allocated.
+void calculate_edges_lighting_model(const mesh_t* mesh, const affine_t* model, const light_t* lights,
+                                    int light_count, float* out_intensity);
+
 
 #endif // LIGHTING_H
\ No newline at end of file
@@ -21,6 +21,70 @@ vec3_t vec3_slerp(vec3_t a, vec3_t b, float t);
 void vec3_print_cartesian(const vec3_t* v);
 void vec3_print_spherical(const vec3_t* v);
 
+// --- vec3f type ---
+// Lean 12-byte cartesian vector for hot paths. Spherical coordinates are not
+// stored; convert explicitly when they are needed.
+
+typedef struct {
+    float x, y, z;
+} vec3f_t;
+
+typedef struct {
+    float r, theta, phi; // radius, azimuth θ = atan2(y, x), polar angle φ = acos(z / r)
+} spherical_t;
+
+// vec3f functions (static inline so callers in other translation units inline them)
+static inline vec3f_t vec3f_make(float x, float y, float z) {
+    vec3f_t v = { x, y, z };
+    return v;
+}
+
+static inline vec3f_t vec3f_add(vec3f_t a, vec3f_t b) {
+    return vec3f_make(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+static inline vec3f_t vec3f_sub(vec3f_t a, vec3f_t b) {
+    return vec3f_make(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+static inline vec3f_t vec3f_scale(vec3f_t v, float s) {
+    return vec3f_make(v.x * s, v.y * s, v.z * s);
+}
+
+static inline float vec3f_dot(vec3f_t a, vec3f_t b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline vec3f_t vec3f_cross(vec3f_t a, vec3f_t b) {
+    return vec3f_make(a.y * b.z - a.z * b.y,
+                      a.z * b.x - a.x * b.z,
+                      a.x * b.y - a.y * b.x);
+}
+
+static inline float vec3f_length(vec3f_t v) {
+    return sqrtf(vec3f_dot(v, v));
+}
+
+static inline vec3f_t vec3f_normalize(vec3f_t v) {
+    float len = vec3f_length(v);
+    if (len < 1e-6f) return vec3f_make(0.0f, 0.0f, 0.0f);
+    return vec3f_scale(v, 1.0f / len);
+}
+
+// Conversions (only these pay for sqrt/atan2/acos or sin/cos)
+static inline vec3f_t vec3f_from_vec3(vec3_t v) {
+    return vec3f_make(v.x, v.y, v.z);
+}
+vec3_t vec3_from_vec3f(vec3f_t v);
+spherical_t vec3f_to_spherical(vec3f_t v);
+vec3f_t vec3f_from_spherical(spherical_t s);
+
+// --- vec4 type ---
+
+typedef struct {
+    float x, y, z, w;   // Homogeneous coordinates
+} vec4_t;
+
 // --- mat4 type ---
 
 typedef struct {
@@ -28,9 +92,31 @@ typedef struct {
 } mat4_t;
 
 // mat4 functions
-mat4_t mat4_identity(void);
-mat4_t mat4_translate(float tx, float ty, float tz);
-mat4_t mat4_scale(float sx, float sy, float sz);
+static inline mat4_t mat4_identity(void) {
+    mat4_t m = { { 1.0f, 0.0f, 0.0f, 0.0f,
+                   0.0f, 1.0f, 0.0f, 0.0f,
+                   0.0f, 0.0f, 1.0f, 0.0f,
+                   0.0f, 0.0f, 0.0f, 1.0f } };
+    return m;
+}
+
+static inline mat4_t mat4_translate(float tx, float ty, float tz) {
+    mat4_t m = mat4_identity();
+    m.m[12] = tx;
+    m.m[13] = ty;
+    m.m[14] = tz;
+    return m;
+}
+
+static inline mat4_t mat4_scale(float sx, float sy, float sz) {
+    mat4_t m = { { 0 } };
+    m.m[0] = sx;
+    m.m[5] = sy;
+    m.m[10] = sz;
+    m.m[15] = 1.0f;
+    return m;
+}
+
 mat4_t mat4_rotate_xyz(float rx, float ry, float rz);
 mat4_t mat4_frustum(float left, float right, float bottom, float top, float near, float far);
 
@@ -38,4 +124,123 @@ mat4_t mat4_frustum(float left, float right, float bottom, float top, float near
 // Matrix multiplication (4x4)
 mat4_t mat4_multiply(mat4_t a, mat4_t b);
 
+// SIMD kernels (SSE/AVX when the compiler targets them, scalar otherwise;
+// define MATH3D_SCALAR to force the scalar paths)
+
+// out = a * b without by-value copies (out may alias a or b)
+void mat4_multiply_into(mat4_t* out, const mat4_t* a, const mat4_t* b);
+
+// Matrix-vector product m * v
+vec4_t mat4_mul_vec4(const mat4_t* m, vec4_t v);
+
+// Transform 'count' points (w = 1) into homogeneous coordinates: out[i] = m * (in[i], 1)
+void mat4_transform_points(const mat4_t* m, const vec3f_t* in, vec4_t* out, int count);
+
+// --- quat type ---
+
+typedef struct {
+    float x, y, z, w;   // w + xi + yj + zk; unit length for rotations
+} quat_t;
+
+// quat functions
+static inline quat_t quat_identity(void) {
+    quat_t q = { 0.0f, 0.0f, 0.0f, 1.0f };
+    return q;
+}
+
+quat_t quat_from_axis_angle(vec3f_t axis, float angle);
+quat_t quat_from_euler_xyz(float rx, float ry, float rz); // same rotation as mat4_rotate_xyz
+quat_t quat_from_mat4(const mat4_t* m);                    // rotation part of m
+quat_t quat_look_rotation(vec3f_t forward);                // rows right, up, -forward (world up Y)
+quat_t quat_nlerp(quat_t a, quat_t b, float t);            // normalized lerp, shortest arc
+quat_t quat_slerp(quat_t a, quat_t b, float t);            // constant angular velocity, shortest arc
+mat4_t quat_to_mat4(quat_t q);
+
+// a * b: rotate by b, then by a
+static inline quat_t quat_multiply(quat_t a, quat_t b) {
+    quat_t q = {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+    return q;
+}
+
+static inline quat_t quat_normalize(quat_t q) {
+    float len_sq = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+    if (len_sq < 1e-12f) return quat_identity();
+    float inv = 1.0f / sqrtf(len_sq);
+    quat_t r = { q.x * inv, q.y * inv, q.z * inv, q.w * inv };
+    return r;
+}
+
+static inline vec3f_t quat_rotate(quat_t q, vec3f_t v) {
+    // v' = v + w * t + u x t, with u = (x, y, z) and t = 2 * (u x v)
+    vec3f_t u = vec3f_make(q.x, q.y, q.z);
+    vec3f_t t = vec3f_scale(vec3f_cross(u, v), 2.0f);
+    return vec3f_add(vec3f_add(v, vec3f_scale(t, q.w)), vec3f_cross(u, t));
+}
+
+// --- affine type ---
+
+typedef struct {
+    float m[12]; // 3x4 row-major: m[row * 4 + col], translation in column 3;
+                 // implicit bottom row (0, 0, 0, 1). Each row is one SSE register.
+} affine_t;
+
+// affine functions (model/view transforms without the projective row)
+static inline affine_t affine_identity(void) {
+    affine_t a = { { 1.0f, 0.0f, 0.0f, 0.0f,
+                     0.0f, 1.0f, 0.0f, 0.0f,
+                     0.0f, 0.0f, 1.0f, 0.0f } };
+    return a;
+}
+
+static inline affine_t affine_translate(float tx, float ty, float tz) {
+    affine_t a = affine_identity();
+    a.m[3] = tx;
+    a.m[7] = ty;
+    a.m[11] = tz;
+    return a;
+}
+
+static inline affine_t affine_scale(float sx, float sy, float sz) {
+    affine_t a = { { 0 } };
+    a.m[0] = sx;
+    a.m[5] = sy;
+    a.m[10] = sz;
+    return a;
+}
+
+affine_t affine_rotate_xyz(float rx, float ry, float rz);  // same rotation as mat4_rotate_xyz
+affine_t affine_from_quat(quat_t q, vec3f_t translation);
+affine_t affine_multiply(affine_t a, affine_t b);          // a * b: 36 mul vs 64 for mat4
+void affine_multiply_into(affine_t* out, const affine_t* a, const affine_t* b); // out may alias a or b
+int affine_inverse(affine_t* out, const affine_t* a);      // -1 if singular (out untouched)
+affine_t affine_inverse_rigid(affine_t a);                 // rotation + translation only
+void affine_transform_points(const affine_t* a, const vec3f_t* in, vec3f_t* out, int count);
+mat4_t affine_to_mat4(affine_t a);
+
+static inline vec3f_t affine_transform_point(const affine_t* a, vec3f_t p) {
+    vec3f_t r = {
+        a->m[0] * p.x + a->m[1] * p.y + a->m[2]  * p.z + a->m[3],
+        a->m[4] * p.x + a->m[5] * p.y + a->m[6]  * p.z + a->m[7],
+        a->m[8] * p.x + a->m[9] * p.y + a->m[10] * p.z + a->m[11]
+    };
+    return r;
+}
+
+static inline vec3f_t affine_transform_dir(const affine_t* a, vec3f_t d) {
+    vec3f_t r = {
+        a->m[0] * d.x + a->m[1] * d.y + a->m[2]  * d.z,
+        a->m[4] * d.x + a->m[5] * d.y + a->m[6]  * d.z,
+        a->m[8] * d.x + a->m[9] * d.y + a->m[10] * d.z
+    };
+    return r;
+}
+
+// Final projection step: out = p * a (48 mul vs 64 for mat4_multiply_into)
+void mat4_multiply_affine(mat4_t* out, const mat4_t* p, const affine_t* a);
+
 #endif // MATH3D_H
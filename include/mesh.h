@@ -0,0 +1,60 @@
+// mesh.h
+#ifndef MESH_H
+#define MESH_H
+
+#include <stddef.h>
+#include "math3d.h"
+
+// Wireframe mesh in structure-of-arrays form: one array per coordinate so
+// batch kernels can load several vertices into one SIMD register.
+typedef struct {
+    float* px;
+    float* py;
+    float* pz;
+    int vert_count;
+    int (*edges)[2];    // vertex index pairs
+    int edge_count;
+
+    // Per-edge cache derived from the positions by mesh_update_edge_cache:
+    // midpoints and their unit directions from the mesh origin (pseudo-normals)
+    float* mid_x;
+    float* mid_y;
+    float* mid_z;
+    float* normal_x;
+    float* normal_y;
+    float* normal_z;
+    vec3f_t bound_center;   // bounding sphere of the vertices
+    float bound_radius;
+
+    // Set by mesh_load: all arrays point into this one block (a private file
+    // mapping, or a heap copy where mmap is unavailable)
+    void* storage;
+    size_t storage_size;
+    int storage_mapped;
+} mesh_t;
+
+// Binary mesh file: a header followed by 64-byte aligned sections holding the
+// SoA positions, the int32 edge pairs and the edge cache, all in host byte order
+#define MESH_FILE_VERSION 1
+
+// Function declarations
+mesh_t* mesh_create(int vert_count, int edge_count);
+mesh_t* mesh_from_vec3(const vec3_t* verts, int vert_count, int edges[][2], int edge_count);
+void mesh_destroy(mesh_t* mesh);
+
+// Overwrite vertex positions and refresh the edge cache
+void mesh_set_positions(mesh_t* mesh, const vec3f_t* points);
+
+// Recompute edge midpoints, normals and the bounding sphere; call after
+// filling a mesh_create'd mesh by hand
+void mesh_update_edge_cache(mesh_t* mesh);
+
+// Write a mesh, edge cache included; -1 on failure
+int mesh_save(const mesh_t* mesh, const char* filename);
+
+// Map a mesh file and use its sections in place; NULL if the file is missing,
+// from another byte order or version, or its sections do not fit. Edge indices
+// are not scanned, so load only trusted files.
+mesh_t* mesh_load(const char* filename);
+
+#endif // MESH_H
@@ -0,0 +1,19 @@
+// mesh_import.h - Streaming OBJ/PLY loader for wireframe meshes
+#ifndef MESH_IMPORT_H
+#define MESH_IMPORT_H
+
+#include "mesh.h"
+
+// Read an .obj or .ply file (ASCII, binary little- or big-endian) in fixed-size
+// chunks. Faces and polylines become unique undirected edges, deduplicated with
+// a hash set, so peak memory follows the vertex and edge counts rather than the
+// file size. NULL on I/O or format errors (reported on stdout). The result is
+// drawn as is with render_wireframe_mesh.
+mesh_t* mesh_import(const char* filename);
+
+// As mesh_import, but reuse cache_filename (a mesh_save file) while the source
+// keeps the size and nanosecond modification time recorded in it, and write it
+// after a fresh import
+mesh_t* mesh_import_cached(const char* filename, const char* cache_filename);
+
+#endif // MESH_IMPORT_H
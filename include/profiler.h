@@ -0,0 +1,60 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+// Pipeline stages timed by the profiler
+typedef enum {
+    PROF_STAGE_TRANSFORM,   // project_vertex batches
+    PROF_STAGE_SORT,        // back-to-front edge sort
+    PROF_STAGE_LIGHTING,    // calculate_edge_lighting
+    PROF_STAGE_RASTER,      // draw_line_f
+    PROF_STAGE_EXPORT,      // canvas_save_pgm
+    PROF_STAGE_COUNT
+} prof_stage_t;
+
+// Event counters accumulated per frame
+typedef enum {
+    PROF_COUNTER_PIXELS_WRITTEN,
+    PROF_COUNTER_LINES_DRAWN,
+    PROF_COUNTER_LINES_CULLED,
+    PROF_COUNTER_BYTES_WRITTEN,
+    PROF_COUNTER_COUNT
+} prof_counter_t;
+
+// Monotonic clock in nanoseconds (always available, also used by the bench suite)
+uint64_t profiler_now_ns(void);
+
+// Frame bookkeeping: stage times and counters between begin/end form one sample
+void profiler_begin_frame(void);
+void profiler_end_frame(void);
+void profiler_reset(void);
+
+// Write per-stage and per-counter percentiles (p50/p90/p99/max) over all frames.
+// Return 0 on success, -1 if the file cannot be written.
+int profiler_dump_csv(const char* filename);
+int profiler_dump_json(const char* filename);
+
+// Current-frame accumulators (use the PROF_* macros rather than touching these)
+extern uint64_t prof_frame_stage_ns[PROF_STAGE_COUNT];
+extern uint64_t prof_frame_counters[PROF_COUNTER_COUNT];
+
+// Instrumentation surface. Build with -DPROFILE (make profile) to enable;
+// otherwise every macro compiles to nothing.
+#ifdef PROFILE
+#define PROF_BEGIN(stage)        uint64_t prof_start_##stage = profiler_now_ns()
+#define PROF_END(stage)          (prof_frame_stage_ns[(stage)] += profiler_now_ns() - prof_start_##stage)
+#define PROF_COUNT(counter, n)   (prof_frame_counters[(counter)] += (uint64_t)(n))
+#define PROF_FRAME_BEGIN()       profiler_begin_frame()
+#define PROF_FRAME_END()         profiler_end_frame()
+#define PROF_DUMP(csv, json)     (profiler_dump_csv(csv), profiler_dump_json(json))
+#else
+#define PROF_BEGIN(stage)        ((void)0)
+#define PROF_END(stage)          ((void)0)
+#define PROF_COUNT(counter, n)   ((void)0)
+#define PROF_FRAME_BEGIN()       ((void)0)
+#define PROF_FRAME_END()         ((void)0)
+#define PROF_DUMP(csv, json)     ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "canvas.h"
 #include "math3d.h"
+#include "mesh.h"
 
 // Struct to store an edge and its average depth
 typedef struct {
@@ -14,13 +15,49 @@ typedef struct {
 // Projects a 3D vertex to 2D screen space
 vec3_t project_vertex(vec3_t v, mat4_t mvp, int width, int height);
 
+// project_vertex for every vertex of a mesh, read straight from its SoA
+// positions; out holds mesh->vert_count entries
+void project_mesh_vertices(const mesh_t* mesh, mat4_t mvp, int width, int height, vec3_t* out);
+
 // Clips a point to a circular viewport
 bool clip_to_circular_viewport(canvas_t* canvas, float x, float y);
 
+#define RENDER_LINE_THICKNESS 1.4f
+
 // Renders a 3D wireframe model with depth sorting
 void render_wireframe(canvas_t* canvas, vec3_t* verts, int vert_count, int edges[][2], int edge_count, mat4_t mvp);
 
+// render_wireframe of a mesh_t's positions and edges, e.g. one from mesh_load,
+// without converting it to a vec3_t array first
+void render_wireframe_mesh(canvas_t* canvas, const mesh_t* mesh, mat4_t mvp);
+
+// Receives each finished band of a strip render, top to bottom. The strip's
+// origin_y is the band's first image row; only its first `rows` rows belong to
+// the image. Return non-zero to stop.
+typedef int (*render_strip_fn)(const canvas_t* strip, int rows, void* user);
+
+// render_wireframe for a width x height image produced band_height rows at a
+// time: edges are ordered by the first band they touch and each band is
+// rasterized from the active edges into one reused strip, giving the same
+// pixels as a full canvas in O(width * band_height + edges) memory. -1 on
+// failure or if emit stopped it.
+int render_wireframe_strips(int width, int height, int band_height, vec3_t* verts, int vert_count,
+                            int edges[][2], int edge_count, mat4_t mvp, render_strip_fn emit, void* user);
+
+// render_wireframe_strips of a mesh_t
+int render_wireframe_mesh_strips(int width, int height, int band_height, const mesh_t* mesh, mat4_t mvp,
+                                 render_strip_fn emit, void* user);
+
+// Strip render straight to a P2 file, identical to canvas_save_pgm of a full render
+int render_wireframe_pgm(const char* filename, int width, int height, int band_height, vec3_t* verts,
+                         int vert_count, int edges[][2], int edge_count, mat4_t mvp);
+
 // Apply smooth quaternion-based rotation (SLERP between two directions)
 mat4_t apply_quaternion_rotation(vec3_t from_dir, vec3_t to_dir, float t);
 
+// Matrix of the renderer's look convention for an orientation from
+// quat_look_rotation: rows right, up and -forward with right = up x forward.
+// That basis is left-handed, so it is quat_to_mat4(q) mirrored in x.
+mat4_t look_rotation_to_mat4(quat_t q);
+
 #endif // RENDERER_H
@@ -0,0 +1,75 @@
+// sequence.h - Frame ranges, sharding and output naming for animation drivers
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <stddef.h>
+#include "canvas.h"
+#include "frame_ring.h"
+
+#define SEQUENCE_PATH_MAX 256
+#define SEQUENCE_RING_SLOTS 8     // frames a --ring consumer may fall behind
+
+// Frames first_frame..last_frame of a sequence, split by stride into
+// shard_count shards; this process renders shard shard_index. Every frame is
+// rendered from its absolute index alone and saved under that index, so the
+// shards' outputs can simply be merged into one directory.
+typedef struct {
+    int fps;
+    float duration;         // seconds
+    int total_frames;       // fps * duration
+    int first_frame;        // inclusive
+    int last_frame;         // inclusive
+    int shard_index;
+    int shard_count;
+    int name_digits;        // minimum digits in frame file names
+    int resume;             // skip frames already written for the same scene
+    long long manifest_ns;  // manifest mtime seen by sequence_sync_manifest
+    char output_dir[SEQUENCE_PATH_MAX];
+    char ring_name[FRAME_RING_NAME_MAX];  // --ring: publish frames here instead of files
+    frame_ring_t* ring;     // opened by sequence_open_ring
+} sequence_t;
+
+// Whole sequence as a single shard, writing to output_dir
+void sequence_init(sequence_t* seq, int fps, float duration, const char* output_dir);
+
+// Apply --fps <n>, --duration <seconds>, --frames <first>:<last>, --shard <i>/<n>,
+// --out <dir>, --resume and --ring <name>. Prints usage and returns -1 on bad or
+// unknown arguments.
+int sequence_parse_args(sequence_t* seq, int argc, char** argv);
+
+// First frame of this shard (> last_frame when the shard is empty); step by shard_count
+int sequence_first(const sequence_t* seq);
+int sequence_frame_count(const sequence_t* seq);
+
+// Seconds since the start of the sequence
+float sequence_time(const sequence_t* seq, int frame);
+
+// "<output_dir>/frame_<index>.pgm" with the absolute frame index
+void sequence_frame_path(const sequence_t* seq, int frame, char* out, size_t size);
+
+// Create the output directory if needed; -1 on failure. Nothing to do when
+// frames go to a ring, and likewise for the manifest and resume checks below.
+int sequence_prepare_output(const sequence_t* seq);
+
+// With --ring, create (or join, for other shards) the shared-memory frame ring;
+// 0 without one. Close it with sequence_close after the last frame.
+int sequence_open_ring(sequence_t* seq, int width, int height);
+void sequence_close(sequence_t* seq);
+
+// Record the scene parameters in <output_dir>/manifest.txt. With resume on,
+// a missing or different manifest turns resume off first, because frames
+// already in the directory belong to another scene; this shard's frames of
+// the range are deleted before the new manifest is written. -1 if it cannot
+// be written.
+int sequence_sync_manifest(sequence_t* seq, const char* scene, int width, int height);
+
+// 1 if resuming and the frame file is a complete width x height P2 image
+// written no earlier than the manifest
+int sequence_frame_done(const sequence_t* seq, int frame, int width, int height);
+
+// Write the frame to a temporary file and rename it into place, so an
+// interrupted run never leaves a truncated frame under the final name.
+// With a ring, publish it there instead (see frame_ring_publish).
+int sequence_save_frame(const sequence_t* seq, canvas_t* canvas, int frame);
+
+#endif // SEQUENCE_H
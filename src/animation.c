@@ -1,6 +1,8 @@
 #include "animation.h"
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Cubic Bezier curve evaluation
 vec3_t bezier(vec3_t p0, vec3_t p1, vec3_t p2, vec3_t p3, float t) {
@@ -31,6 +33,105 @@ vec3_t bezier(vec3_t p0, vec3_t p1, vec3_t p2, vec3_t p3, float t) {
     return result;
 }
 
+// Arc-length tables
+
+// Chord samples per Bezier segment used to measure length
+#define ARC_STEPS_PER_SEGMENT 64
+
+// Point at global parameter g: segment (int)g, Bezier t = fraction of g
+static vec3_t arc_point(const vec3_t* ctrl, int segment_count, float g) {
+    int seg = (int)g;
+    if (seg > segment_count - 1) seg = segment_count - 1;
+    if (seg < 0) seg = 0;
+    const vec3_t* c = ctrl + seg * 3;
+    return bezier(c[0], c[1], c[2], c[3], g - (float)seg);
+}
+
+static float arc_step(vec3_t a, vec3_t b) {
+    float dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+// Fill table[0..table_size] with the global parameter at uniform fractions of
+// the chord length and return the length. joints (segment_count + 1 entries,
+// may be NULL) receives the length fraction at each segment start. The chords
+// are walked twice instead of being stored, so building needs no allocation.
+static float arc_table_build(const vec3_t* ctrl, int segment_count, float* table, int table_size, float* joints) {
+    int steps = segment_count * ARC_STEPS_PER_SEGMENT;
+    float g_step = (float)segment_count / steps;
+
+    float total = 0.0f;
+    vec3_t prev = arc_point(ctrl, segment_count, 0.0f);
+    for (int j = 1; j <= steps; j++) {
+        vec3_t p = arc_point(ctrl, segment_count, j * g_step);
+        total += arc_step(prev, p);
+        prev = p;
+    }
+
+    table[0] = 0.0f;
+    table[table_size] = (float)segment_count;
+    if (joints) {
+        for (int seg = 0; seg <= segment_count; seg++) joints[seg] = (float)seg / segment_count;
+    }
+    if (total <= 0.0f) {
+        for (int k = 1; k < table_size; k++) table[k] = (float)segment_count * k / table_size;
+        return 0.0f;
+    }
+
+    int k = 1;
+    float len = 0.0f;
+    prev = arc_point(ctrl, segment_count, 0.0f);
+    for (int j = 1; j <= steps; j++) {
+        vec3_t p = arc_point(ctrl, segment_count, j * g_step);
+        float step = arc_step(prev, p);
+        float next = len + step;
+        while (k < table_size && total * k / table_size <= next) {
+            float u = step > 0.0f ? (total * k / table_size - len) / step : 0.0f;
+            table[k++] = ((j - 1) + u) * g_step;
+        }
+        if (joints && j % ARC_STEPS_PER_SEGMENT == 0 && j < steps) {
+            joints[j / ARC_STEPS_PER_SEGMENT] = next / total;
+        }
+        len = next;
+        prev = p;
+    }
+    // Rounding can leave the last entries unset
+    for (; k < table_size; k++) table[k] = (float)segment_count;
+    return total;
+}
+
+// Global parameter at fraction s of the length: one index and one lerp.
+// Speed along g jumps at segment joints, so an entry pair that straddles a
+// joint is split there (joints may be NULL for a single segment).
+static float arc_table_lookup(const float* table, int table_size, const float* joints, float s) {
+    if (s <= 0.0f) return table[0];
+    if (s >= 1.0f) return table[table_size];
+    float f = s * table_size;
+    int i = (int)f;
+    float g0 = table[i], g1 = table[i + 1];
+    if (!joints || (int)g0 == (int)g1) {
+        return g0 + (g1 - g0) * (f - (float)i);
+    }
+
+    float s0 = (float)i / table_size, s1 = (float)(i + 1) / table_size;
+    for (int seg = (int)g0 + 1; seg <= (int)g1 && seg < (int)table[table_size]; seg++) {
+        if (s < joints[seg]) {
+            s1 = joints[seg];
+            g1 = (float)seg;
+            break;
+        }
+        s0 = joints[seg];
+        g0 = (float)seg;
+    }
+    return s1 > s0 ? g0 + (g1 - g0) * (s - s0) / (s1 - s0) : g0;
+}
+
+// Wrap time into [0, 1) of duration
+static float loop_fraction(float time, float duration) {
+    float t = fmodf(time / duration, 1.0f);
+    return t < 0.0f ? t + 1.0f : t;
+}
+
 // Create an animation keyframe
 animation_keyframe_t keyframe_create(vec3_t position, vec3_t rotation, vec3_t scale, float time) {
     animation_keyframe_t keyframe;
@@ -71,6 +172,10 @@ animation_path_t path_create(vec3_t p0, vec3_t p1, vec3_t p2, vec3_t p3, float d
     }
     
     path.duration = duration > 0.0f ? duration : 1.0f; // Prevent invalid duration
+
+    vec3_t ctrl[4] = { path.p0, path.p1, path.p2, path.p3 };
+    path.length = arc_table_build(ctrl, 1, path.arc_table, PATH_ARC_SAMPLES, NULL);
+    path.has_arc_table = 1;
     
     #ifdef DEBUG
     printf("Created path: duration=%.3f, p0=(%.2f, %.2f, %.2f), p3=(%.2f, %.2f, %.2f)\n",
@@ -81,22 +186,22 @@ animation_path_t path_create(vec3_t p0, vec3_t p1, vec3_t p2, vec3_t p3, float d
 }
 
 // Evaluate animation path at given time
-vec3_t path_evaluate(animation_path_t path, float time) {
-    if (path.duration <= 0.0f) {
+vec3_t path_evaluate(const animation_path_t* path, float time) {
+    if (path->duration <= 0.0f) {
         #ifdef DEBUG
-        printf("Warning: Invalid path duration (%.3f), returning p0\n", path.duration);
+        printf("Warning: Invalid path duration (%.3f), returning p0\n", path->duration);
         #endif
-        return path.p0;
+        return path->p0;
     }
     
-    float t = time / path.duration;
+    float t = time / path->duration;
     t = fmodf(t, 1.0f);
     if (t < 0.0f) t += 1.0f;
     
     // Apply quintic easing for smoother orbital motion
     float t_eased = t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); // t^5 easing
     
-    vec3_t result = bezier(path.p0, path.p1, path.p2, path.p3, t_eased);
+    vec3_t result = bezier(path->p0, path->p1, path->p2, path->p3, t_eased);
     
     #ifdef DEBUG
     printf("Path evaluated at t=%.3f (eased): pos=(%.2f, %.2f, %.2f)\n", t, result.x, result.y, result.z);
@@ -105,6 +210,63 @@ vec3_t path_evaluate(animation_path_t path, float time) {
     return result;
 }
 
+vec3_t path_at_distance(const animation_path_t* path, float s) {
+    const float* table = path->arc_table;
+    float scratch[PATH_ARC_SAMPLES + 1];
+    if (!path->has_arc_table) {
+        // Not from path_create: build the table for this call only
+        vec3_t ctrl[4] = { path->p0, path->p1, path->p2, path->p3 };
+        arc_table_build(ctrl, 1, scratch, PATH_ARC_SAMPLES, NULL);
+        table = scratch;
+    }
+    float t = arc_table_lookup(table, PATH_ARC_SAMPLES, NULL, s);
+    return bezier(path->p0, path->p1, path->p2, path->p3, t);
+}
+
+vec3_t path_evaluate_uniform(const animation_path_t* path, float time) {
+    if (path->duration <= 0.0f) return path->p0;
+    return path_at_distance(path, loop_fraction(time, path->duration));
+}
+
+animation_spline_t* spline_create(const vec3_t* points, int segment_count, float duration) {
+    if (!points || segment_count < 1) return NULL;
+
+    animation_spline_t* spline = calloc(1, sizeof(animation_spline_t));
+    if (!spline) return NULL;
+    spline->segment_count = segment_count;
+    spline->duration = duration > 0.0f ? duration : 1.0f;
+    spline->table_size = segment_count * PATH_ARC_SAMPLES;
+    spline->points = malloc((3 * segment_count + 1) * sizeof(vec3_t));
+    spline->arc_table = malloc((spline->table_size + 1) * sizeof(float));
+    spline->joints = malloc((segment_count + 1) * sizeof(float));
+    if (!spline->points || !spline->arc_table || !spline->joints) {
+        spline_destroy(spline);
+        return NULL;
+    }
+
+    memcpy(spline->points, points, (3 * segment_count + 1) * sizeof(vec3_t));
+    spline->length = arc_table_build(spline->points, segment_count, spline->arc_table, spline->table_size,
+                                     spline->joints);
+    return spline;
+}
+
+void spline_destroy(animation_spline_t* spline) {
+    if (!spline) return;
+
+    free(spline->points);
+    free(spline->arc_table);
+    free(spline->joints);
+    free(spline);
+}
+
+vec3_t spline_at_distance(const animation_spline_t* spline, float s) {
+    float g = arc_table_lookup(spline->arc_table, spline->table_size, spline->joints, s);
+    return arc_point(spline->points, spline->segment_count, g);
+}
+
+vec3_t spline_evaluate_uniform(const animation_spline_t* spline, float time) {
+    return spline_at_distance(spline, loop_fraction(time, spline->duration));
+}
 
 // Smooth step function for easing
 float smooth_step(float t) {
@@ -156,4 +318,183 @@ vec3_t rotate_around_axis(vec3_t axis, float angle, float time, float duration)
     #endif
     
     return result;
-}
\ No newline at end of file
+}
+
+// Bake a path and a constant Euler spin into per-frame samples
+animation_track_t* track_bake(const animation_path_t* path, vec3f_t spin, float fps, int frame_count) {
+    if (fps <= 0.0f || frame_count <= 0) return NULL;
+
+    animation_track_t* track = calloc(1, sizeof(animation_track_t));
+    if (!track) return NULL;
+    track->fps = fps;
+    track->frame_count = frame_count;
+    track->positions = malloc(frame_count * sizeof(vec3f_t));
+    track->orientations = malloc(frame_count * sizeof(quat_t));
+    if (!track->positions || !track->orientations) {
+        track_destroy(track);
+        return NULL;
+    }
+
+    // Same time base as a frame loop stepping by 1/fps
+    float frame_time = 1.0f / fps;
+    for (int i = 0; i < frame_count; i++) {
+        float time = i * frame_time;
+        track->positions[i] = path ? vec3f_from_vec3(path_evaluate(path, time)) : vec3f_make(0.0f, 0.0f, 0.0f);
+        track->orientations[i] = quat_from_euler_xyz(spin.x * time, spin.y * time, spin.z * time);
+    }
+    return track;
+}
+
+void track_destroy(animation_track_t* track) {
+    if (!track) return;
+
+    free(track->positions);
+    free(track->orientations);
+    free(track);
+}
+
+// Blend the two baked frames around time
+affine_t track_sample(const animation_track_t* track, float time) {
+    float f = time * track->fps;
+    if (f <= 0.0f) return track_frame(track, 0);
+    if (f >= (float)(track->frame_count - 1)) return track_frame(track, track->frame_count - 1);
+
+    int i = (int)f;
+    float t = f - (float)i;
+    vec3f_t a = track->positions[i], b = track->positions[i + 1];
+    vec3f_t pos = vec3f_make(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+    return affine_from_quat(quat_nlerp(track->orientations[i], track->orientations[i + 1], t), pos);
+}
+
+// Keyframe timelines
+
+animation_timeline_t* timeline_create(const animation_keyframe_t* keys, int key_count) {
+    if (!keys || key_count <= 0) return NULL;
+    for (int i = 1; i < key_count; i++) {
+        if (keys[i].time < keys[i - 1].time) {
+            #ifdef DEBUG
+            printf("Warning: Keyframe %d is out of order (%.3f < %.3f)\n", i, keys[i].time, keys[i - 1].time);
+            #endif
+            return NULL;
+        }
+    }
+
+    animation_timeline_t* timeline = calloc(1, sizeof(animation_timeline_t));
+    if (!timeline) return NULL;
+
+    // One block for all ten channel arrays
+    float* block = malloc(10 * key_count * sizeof(float));
+    if (!block) {
+        free(timeline);
+        return NULL;
+    }
+    timeline->key_count = key_count;
+    timeline->times = block;
+    timeline->pos_x = block + 1 * key_count;
+    timeline->pos_y = block + 2 * key_count;
+    timeline->pos_z = block + 3 * key_count;
+    timeline->rot_x = block + 4 * key_count;
+    timeline->rot_y = block + 5 * key_count;
+    timeline->rot_z = block + 6 * key_count;
+    timeline->scale_x = block + 7 * key_count;
+    timeline->scale_y = block + 8 * key_count;
+    timeline->scale_z = block + 9 * key_count;
+
+    for (int i = 0; i < key_count; i++) {
+        timeline->times[i] = keys[i].time;
+        timeline->pos_x[i] = keys[i].position.x;
+        timeline->pos_y[i] = keys[i].position.y;
+        timeline->pos_z[i] = keys[i].position.z;
+        timeline->rot_x[i] = keys[i].rotation.x;
+        timeline->rot_y[i] = keys[i].rotation.y;
+        timeline->rot_z[i] = keys[i].rotation.z;
+        timeline->scale_x[i] = keys[i].scale.x;
+        timeline->scale_y[i] = keys[i].scale.y;
+        timeline->scale_z[i] = keys[i].scale.z;
+    }
+    return timeline;
+}
+
+void timeline_destroy(animation_timeline_t* timeline) {
+    if (!timeline) return;
+
+    free(timeline->times);
+    free(timeline);
+}
+
+// Index i of the segment [times[i], times[i + 1]] containing time, which the
+// caller has clamped to the key range
+static int timeline_segment(animation_timeline_t* timeline, float time) {
+    const float* times = timeline->times;
+    int last = timeline->key_count - 2;
+    int c = timeline->cursor;
+
+    // Playback moves forward by less than a segment most frames
+    if (time >= times[c]) {
+        if (c == last || time < times[c + 1]) return c;
+        if (c + 1 == last || time < times[c + 2]) return timeline->cursor = c + 1;
+    }
+
+    // Seek: last key at or before time
+    int lo = 0, hi = last;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (times[mid] <= time) lo = mid;
+        else hi = mid - 1;
+    }
+    return timeline->cursor = lo;
+}
+
+static float channel_lerp(const float* channel, int i, int j, float u) {
+    return channel[i] + (channel[j] - channel[i]) * u;
+}
+
+void timeline_evaluate(animation_timeline_t* timeline, float time, vec3f_t* position, vec3f_t* rotation, vec3f_t* scale) {
+    int i = 0;
+    float u = 0.0f;
+
+    if (timeline->key_count > 1) {
+        const float* times = timeline->times;
+        if (time <= times[0]) {
+            time = times[0];
+        } else if (time >= times[timeline->key_count - 1]) {
+            time = times[timeline->key_count - 1];
+        }
+        i = timeline_segment(timeline, time);
+        float span = times[i + 1] - times[i];
+        u = span > 0.0f ? (time - times[i]) / span : 1.0f;  // coincident keys step
+    }
+    int j = timeline->key_count > 1 ? i + 1 : i;
+
+    if (position) {
+        *position = vec3f_make(channel_lerp(timeline->pos_x, i, j, u), channel_lerp(timeline->pos_y, i, j, u),
+                               channel_lerp(timeline->pos_z, i, j, u));
+    }
+    if (rotation) {
+        *rotation = vec3f_make(channel_lerp(timeline->rot_x, i, j, u), channel_lerp(timeline->rot_y, i, j, u),
+                               channel_lerp(timeline->rot_z, i, j, u));
+    }
+    if (scale) {
+        *scale = vec3f_make(channel_lerp(timeline->scale_x, i, j, u), channel_lerp(timeline->scale_y, i, j, u),
+                            channel_lerp(timeline->scale_z, i, j, u));
+    }
+}
+
+void timelines_evaluate(animation_timeline_t* const* timelines, int count, float time, affine_t* out) {
+    for (int k = 0; k < count; k++) {
+        vec3f_t pos, rot, scl;
+        timeline_evaluate(timelines[k], time, &pos, &rot, &scl);
+
+        // T * R * S: scale the rotation columns, translation in the last column
+        affine_t m = affine_rotate_xyz(rot.x, rot.y, rot.z);
+        for (int r = 0; r < 3; r++) {
+            m.m[r * 4 + 0] *= scl.x;
+            m.m[r * 4 + 1] *= scl.y;
+            m.m[r * 4 + 2] *= scl.z;
+        }
+        m.m[3] = pos.x;
+        m.m[7] = pos.y;
+        m.m[11] = pos.z;
+        out[k] = m;
+    }
+}
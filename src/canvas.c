@@ -1,73 +1,381 @@
 // canvas.c
 #include "canvas.h"
+#include "profiler.h"
 #include <stdint.h> // in case it's not included already
+#include <string.h>
+
+#define TILE_MASK (CANVAS_TILE_SIZE - 1)
+#define BLOCK_MASK (CANVAS_BLOCK_SIZE - 1)
+
+// Blocked canvases keep their guard band as whole blocks
+typedef char guard_block_check[CANVAS_GUARD % CANVAS_BLOCK_SIZE == 0 ? 1 : -1];
+
+// floor() for coordinates well inside int range, without the libm call
+static inline int floor_to_int(float v) {
+    int i = (int)v;
+    return i - (v < (float)i);
+}
+
+static inline float clamp_one(float v) {
+    return v > 1.0f ? 1.0f : v;
+}
+
+// Endpoints the unchecked line loops accept: finite, and small enough that
+// rounding in the sample positions stays well under a pixel. False for NaN.
+#define GUARDED_COORD_MAX 1048576.0f
+
+static inline int guarded_coord(float v) {
+    return fabsf(v) <= GUARDED_COORD_MAX;
+}
+
+#ifdef PROFILE
+// Pixels of a splat at canvas row y (origin_y already subtracted) that lie
+// inside the canvas: what set_pixel_f would count for it
+static int splat_pixels_inside(const canvas_t* canvas, int x, int y) {
+    int columns = (x >= 0 && x < canvas->width) + (x + 1 >= 0 && x + 1 < canvas->width);
+    int rows = (y >= 0 && y < canvas->height) + (y + 1 >= 0 && y + 1 < canvas->height);
+    return columns * rows;
+}
+#endif
+
+
+// Falloff profiles for thick lines. The profile only depends on the integer
+// number of perpendicular samples (thickness_steps), so one row per count is
+// exact. The canvas constructors build the rows, so they are ready before any
+// line is drawn and drawing threads only ever read them.
+#define FALLOFF_MAX_STEPS 64
+
+static float falloff_table[FALLOFF_MAX_STEPS + 1][FALLOFF_MAX_STEPS];
+static int falloff_ready = 0;
+
+static float falloff_ratio(int t, int thickness_steps) {
+    return (thickness_steps == 1) ? 0 : (float)t / (thickness_steps - 1) - 0.5f;
+}
+
+static void falloff_build(void) {
+    if (falloff_ready) return;
+    for (int n = 1; n <= FALLOFF_MAX_STEPS; n++) {
+        for (int t = 0; t < n; t++) {
+            float t_ratio = falloff_ratio(t, n);
+            // Gaussian-like falloff for smoother thickness
+            falloff_table[n][t] = exp(-2.0f * t_ratio * t_ratio);
+        }
+    }
+    falloff_ready = 1;
+}
 
 canvas_t* canvas_create(int width, int height) {
     canvas_t* canvas = malloc(sizeof(canvas_t));
     if (!canvas) return NULL;
+    falloff_build();
     
     canvas->width = width;
     canvas->height = height;
+    canvas->origin_y = 0;
+    canvas->tiles = NULL;
+    canvas->tiles_x = 0;
+    canvas->tiles_y = 0;
+    canvas->blocks = NULL;
+    canvas->blocks_x = 0;
+    canvas->guard = CANVAS_GUARD;
     
-    // Allocate 2D array for pixels
-    canvas->pixels = malloc(height * sizeof(float*));
-    if (!canvas->pixels) {
+    // Allocate 2D array for pixels: one block of rows, each with guard pixels
+    // either side, plus guard rows above and below
+    int rows = height + 2 * CANVAS_GUARD;
+    size_t stride = (size_t)width + 2 * CANVAS_GUARD;
+    float** row_pointers = malloc(rows * sizeof(float*));
+    float* storage = calloc(stride * rows, sizeof(float));
+    if (!row_pointers || !storage) {
+        free(row_pointers);
+        free(storage);
         free(canvas);
         return NULL;
     }
     
-    for (int i = 0; i < height; i++) {
-        canvas->pixels[i] = calloc(width, sizeof(float));
-        if (!canvas->pixels[i]) {
-            // Clean up on failure
-            for (int j = 0; j < i; j++) {
-                free(canvas->pixels[j]);
-            }
-            free(canvas->pixels);
-            free(canvas);
-            return NULL;
-        }
+    for (int i = 0; i < rows; i++) {
+        row_pointers[i] = storage + i * stride + CANVAS_GUARD;
     }
+    canvas->pixels = row_pointers + CANVAS_GUARD;
     
     return canvas;
 }
 
+// Start of a row-major canvas's storage, guard band included
+static float* guarded_storage(const canvas_t* canvas) {
+    return canvas->pixels[-canvas->guard] - canvas->guard;
+}
+
+static size_t guarded_size(const canvas_t* canvas) {
+    return ((size_t)canvas->width + 2 * canvas->guard) * (canvas->height + 2 * canvas->guard);
+}
+
+canvas_t* canvas_create_sparse(int width, int height) {
+    if (width <= 0 || height <= 0) return NULL;
+    canvas_t* canvas = calloc(1, sizeof(canvas_t));
+    if (!canvas) return NULL;
+    falloff_build();
+
+    canvas->width = width;
+    canvas->height = height;
+    canvas->tiles_x = (width + TILE_MASK) >> CANVAS_TILE_SHIFT;
+    canvas->tiles_y = (height + TILE_MASK) >> CANVAS_TILE_SHIFT;
+
+    // Only the tile directory is allocated up front (2 MB for 32k x 32k)
+    canvas->tiles = calloc((size_t)canvas->tiles_x * canvas->tiles_y, sizeof(float*));
+    if (!canvas->tiles) {
+        free(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+// Block rows including the guard band
+static size_t block_rows(const canvas_t* canvas) {
+    return (size_t)(canvas->height + 2 * canvas->guard + BLOCK_MASK) >> CANVAS_BLOCK_SHIFT;
+}
+
+canvas_t* canvas_create_blocked(int width, int height) {
+    if (width <= 0 || height <= 0) return NULL;
+    canvas_t* canvas = calloc(1, sizeof(canvas_t));
+    if (!canvas) return NULL;
+    falloff_build();
+
+    canvas->width = width;
+    canvas->height = height;
+    canvas->guard = CANVAS_GUARD;
+    canvas->blocks_x = (width + 2 * CANVAS_GUARD + BLOCK_MASK) >> CANVAS_BLOCK_SHIFT;
+    canvas->blocks = calloc(block_rows(canvas) * canvas->blocks_x * CANVAS_BLOCK_SIZE * CANVAS_BLOCK_SIZE, sizeof(float));
+    if (!canvas->blocks) {
+        free(canvas);
+        return NULL;
+    }
+    return canvas;
+}
+
+static void free_tiles(canvas_t* canvas, int first_row, int row_count) {
+    float** tiles = canvas->tiles + (size_t)first_row * canvas->tiles_x;
+    for (size_t i = 0; i < (size_t)row_count * canvas->tiles_x; i++) {
+        free(tiles[i]);
+        tiles[i] = NULL;
+    }
+}
+
 void canvas_destroy(canvas_t* canvas) {
     if (!canvas) return;
     
-    for (int i = 0; i < canvas->height; i++) {
-        free(canvas->pixels[i]);
+    if (canvas->tiles) {
+        free_tiles(canvas, 0, canvas->tiles_y);
+        free(canvas->tiles);
+        free(canvas);
+        return;
     }
-    free(canvas->pixels);
+    if (canvas->blocks) {
+        free(canvas->blocks);
+        free(canvas);
+        return;
+    }
+    free(guarded_storage(canvas));
+    free(canvas->pixels - canvas->guard);
     free(canvas);
 }
 
 void canvas_clear(canvas_t* canvas) {
     if (!canvas) return;
     
-    for (int y = 0; y < canvas->height; y++) {
-        for (int x = 0; x < canvas->width; x++) {
-            canvas->pixels[y][x] = 0.0f;
+    if (canvas->tiles) {
+        free_tiles(canvas, 0, canvas->tiles_y);
+        return;
+    }
+    if (canvas->blocks) {
+        memset(canvas->blocks, 0, block_rows(canvas) * canvas->blocks_x * CANVAS_BLOCK_SIZE * CANVAS_BLOCK_SIZE * sizeof(float));
+        return;
+    }
+    // The guard band too, so it never holds stale values
+    memset(guarded_storage(canvas), 0, guarded_size(canvas) * sizeof(float));
+}
+
+// Add to an in-bounds pixel of a sparse canvas, allocating its tile on first
+// use. If that allocation fails the write is dropped.
+static void sparse_add(canvas_t* canvas, int x, int y, float value) {
+    float** tile = &canvas->tiles[(y >> CANVAS_TILE_SHIFT) * canvas->tiles_x + (x >> CANVAS_TILE_SHIFT)];
+    if (!*tile) {
+        *tile = calloc(CANVAS_TILE_SIZE * CANVAS_TILE_SIZE, sizeof(float));
+        if (!*tile) return;
+    }
+    float* pixel = *tile + ((y & TILE_MASK) << CANVAS_TILE_SHIFT) + (x & TILE_MASK);
+    *pixel += value;
+    if (*pixel > 1.0f) *pixel = 1.0f;
+    PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 1);
+}
+
+// set_pixel_f for sparse canvases: the same weights, written through the tiles
+static void sparse_set_pixel(canvas_t* canvas, float x, float y, float intensity) {
+    if (intensity > 1.0f) intensity = 1.0f;
+
+    int x0 = (int)floor(x);
+    int iy = (int)floor(y);
+    int x1 = x0 + 1;
+    float fx = x - x0;
+    float fy = y - iy;
+    int y0 = iy - canvas->origin_y;
+    int y1 = y0 + 1;
+
+    int in_x0 = x0 >= 0 && x0 < canvas->width;
+    int in_x1 = x1 >= 0 && x1 < canvas->width;
+    int in_y0 = y0 >= 0 && y0 < canvas->height;
+    int in_y1 = y1 >= 0 && y1 < canvas->height;
+    if (in_x0 && in_y0) sparse_add(canvas, x0, y0, (1.0f - fx) * (1.0f - fy) * intensity);
+    if (in_x1 && in_y0) sparse_add(canvas, x1, y0, fx * (1.0f - fy) * intensity);
+    if (in_x0 && in_y1) sparse_add(canvas, x0, y1, (1.0f - fx) * fy * intensity);
+    if (in_x1 && in_y1) sparse_add(canvas, x1, y1, fx * fy * intensity);
+}
+
+// Pixel (x, y) of a blocked canvas, guard band included: its block, then
+// row-major within the block
+static inline float* block_cell(const canvas_t* canvas, int x, int y) {
+    x += canvas->guard;
+    y += canvas->guard;
+    size_t block = (size_t)(y >> CANVAS_BLOCK_SHIFT) * canvas->blocks_x + (x >> CANVAS_BLOCK_SHIFT);
+    return canvas->blocks + (block << (2 * CANVAS_BLOCK_SHIFT)) + ((y & BLOCK_MASK) << CANVAS_BLOCK_SHIFT) + (x & BLOCK_MASK);
+}
+
+static inline void block_add(float* pixel, float value) {
+    *pixel += value;
+    if (*pixel > 1.0f) *pixel = 1.0f;
+    PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 1);
+}
+
+// Bilinear splat with its top-left pixel at addressable (x, y). The right and
+// lower neighbours are stepped to from that one cell, within or across blocks.
+static inline void block_splat(const canvas_t* canvas, int x, int y, float fx, float fy, float v) {
+    float* p00 = block_cell(canvas, x, y);
+    float* p10 = p00 + ((x & BLOCK_MASK) != BLOCK_MASK ? 1 : CANVAS_BLOCK_SIZE * CANVAS_BLOCK_SIZE - BLOCK_MASK);
+    size_t down = (y & BLOCK_MASK) != BLOCK_MASK
+        ? CANVAS_BLOCK_SIZE
+        : ((size_t)canvas->blocks_x << (2 * CANVAS_BLOCK_SHIFT)) - BLOCK_MASK * CANVAS_BLOCK_SIZE;
+    p00[0] = clamp_one(p00[0] + (1.0f - fx) * (1.0f - fy) * v);
+    p10[0] = clamp_one(p10[0] + fx * (1.0f - fy) * v);
+    p00[down] = clamp_one(p00[down] + (1.0f - fx) * fy * v);
+    p10[down] = clamp_one(p10[down] + fx * fy * v);
+}
+
+// set_pixel_f for blocked canvases: the same weights and order of additions
+static inline void blocked_set_pixel(canvas_t* canvas, float x, float y, float intensity) {
+    if (intensity > 1.0f) intensity = 1.0f;
+
+    int x0 = (int)floor(x);
+    int iy = (int)floor(y);
+    int x1 = x0 + 1;
+    float fx = x - x0;
+    float fy = y - iy;
+    int y0 = iy - canvas->origin_y;
+    int y1 = y0 + 1;
+
+    // Interior splats (the common case) need a single block lookup
+    if (x0 >= 0 && x1 < canvas->width && y0 >= 0 && y1 < canvas->height) {
+        block_splat(canvas, x0, y0, fx, fy, intensity);
+        PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 4);
+        return;
+    }
+    int in_x0 = x0 >= 0 && x0 < canvas->width;
+    int in_x1 = x1 >= 0 && x1 < canvas->width;
+    int in_y0 = y0 >= 0 && y0 < canvas->height;
+    int in_y1 = y1 >= 0 && y1 < canvas->height;
+    if (in_x0 && in_y0) block_add(block_cell(canvas, x0, y0), (1.0f - fx) * (1.0f - fy) * intensity);
+    if (in_x1 && in_y0) block_add(block_cell(canvas, x1, y0), fx * (1.0f - fy) * intensity);
+    if (in_x0 && in_y1) block_add(block_cell(canvas, x0, y1), (1.0f - fx) * fy * intensity);
+    if (in_x1 && in_y1) block_add(block_cell(canvas, x1, y1), fx * fy * intensity);
+}
+
+float canvas_get_pixel(const canvas_t* canvas, int x, int y) {
+    if (canvas) y -= canvas->origin_y;
+    if (!canvas || x < 0 || x >= canvas->width || y < 0 || y >= canvas->height) return 0.0f;
+    if (canvas->pixels) return canvas->pixels[y][x];
+    if (canvas->blocks) return *block_cell(canvas, x, y);
+
+    const float* tile = canvas->tiles[(y >> CANVAS_TILE_SHIFT) * canvas->tiles_x + (x >> CANVAS_TILE_SHIFT)];
+    return tile ? tile[((y & TILE_MASK) << CANVAS_TILE_SHIFT) + (x & TILE_MASK)] : 0.0f;
+}
+
+const float* canvas_row(const canvas_t* canvas, int y, float* scratch) {
+    if (canvas->pixels) return canvas->pixels[y];
+    if (canvas->blocks) {
+        // One run of CANVAS_BLOCK_SIZE pixels from each block along the row
+        const float* run = block_cell(canvas, 0, y);
+        for (int x0 = 0; x0 < canvas->width; x0 += CANVAS_BLOCK_SIZE) {
+            int n = canvas->width - x0 < CANVAS_BLOCK_SIZE ? canvas->width - x0 : CANVAS_BLOCK_SIZE;
+            memcpy(scratch + x0, run, n * sizeof(float));
+            run += CANVAS_BLOCK_SIZE * CANVAS_BLOCK_SIZE;
         }
+        return scratch;
+    }
+
+    float* const* tiles = canvas->tiles + (size_t)(y >> CANVAS_TILE_SHIFT) * canvas->tiles_x;
+    int offset = (y & TILE_MASK) << CANVAS_TILE_SHIFT;
+    for (int tx = 0; tx < canvas->tiles_x; tx++) {
+        int x0 = tx << CANVAS_TILE_SHIFT;
+        int n = canvas->width - x0 < CANVAS_TILE_SIZE ? canvas->width - x0 : CANVAS_TILE_SIZE;
+        if (tiles[tx]) {
+            memcpy(scratch + x0, tiles[tx] + offset, n * sizeof(float));
+        } else {
+            memset(scratch + x0, 0, n * sizeof(float));
+        }
+    }
+    return scratch;
+}
+
+int canvas_tile_count(const canvas_t* canvas) {
+    if (!canvas || !canvas->tiles) return 0;
+    int count = 0;
+    for (size_t i = 0; i < (size_t)canvas->tiles_x * canvas->tiles_y; i++) {
+        count += canvas->tiles[i] != NULL;
+    }
+    return count;
+}
+
+// Narrow [first, last] to the samples i whose coordinate start + i * step
+// comes within reach of [low, low + size); one extra sample either end
+// absorbs rounding in the division
+static void clip_samples(float start, float step, float reach, int low, int size, int steps, int* first, int* last) {
+    float near_edge = low - reach;
+    float far_edge = low + size + reach;
+    if (step != 0.0f) {
+        float lo = fminf((near_edge - start) / step, (far_edge - start) / step) - 1.0f;
+        float hi = fmaxf((near_edge - start) / step, (far_edge - start) / step) + 1.0f;
+        if (lo > *first) *first = lo > steps ? steps + 1 : (int)lo;
+        if (hi < *last) *last = hi < 0.0f ? -1 : (int)hi;
+    } else if (start < near_edge || start > far_edge) {
+        *last = -1;
     }
 }
 
 // Bilinear filtering for sub-pixel precision
 void set_pixel_f(canvas_t* canvas, float x, float y, float intensity) {
     if (!canvas || intensity < 0.0f) return;
+    if (canvas->tiles) {
+        sparse_set_pixel(canvas, x, y, intensity);
+        return;
+    }
+    if (canvas->blocks) {
+        blocked_set_pixel(canvas, x, y, intensity);
+        return;
+    }
     
     // Clamp intensity to [0.0, 1.0]
     if (intensity > 1.0f) intensity = 1.0f;
     
     // Get the four surrounding integer pixel coordinates
     int x0 = (int)floor(x);
-    int y0 = (int)floor(y);
+    int iy = (int)floor(y);
     int x1 = x0 + 1;
-    int y1 = y0 + 1;
     
     // Calculate fractional parts
     float fx = x - x0;
-    float fy = y - y0;
+    float fy = y - iy;
+    
+    // Rows of this canvas (strips start at origin_y)
+    int y0 = iy - canvas->origin_y;
+    int y1 = y0 + 1;
     
     // Bilinear weights
     float w00 = (1.0f - fx) * (1.0f - fy);  // top-left
@@ -79,24 +387,30 @@ void set_pixel_f(canvas_t* canvas, float x, float y, float intensity) {
     if (x0 >= 0 && x0 < canvas->width && y0 >= 0 && y0 < canvas->height) {
         canvas->pixels[y0][x0] += w00 * intensity;
         if (canvas->pixels[y0][x0] > 1.0f) canvas->pixels[y0][x0] = 1.0f;
+        PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 1);
     }
     if (x1 >= 0 && x1 < canvas->width && y0 >= 0 && y0 < canvas->height) {
         canvas->pixels[y0][x1] += w10 * intensity;
         if (canvas->pixels[y0][x1] > 1.0f) canvas->pixels[y0][x1] = 1.0f;
+        PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 1);
     }
     if (x0 >= 0 && x0 < canvas->width && y1 >= 0 && y1 < canvas->height) {
         canvas->pixels[y1][x0] += w01 * intensity;
         if (canvas->pixels[y1][x0] > 1.0f) canvas->pixels[y1][x0] = 1.0f;
+        PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 1);
     }
     if (x1 >= 0 && x1 < canvas->width && y1 >= 0 && y1 < canvas->height) {
         canvas->pixels[y1][x1] += w11 * intensity;
         if (canvas->pixels[y1][x1] > 1.0f) canvas->pixels[y1][x1] = 1.0f;
+        PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, 1);
     }
 }
 
 // DDA (Digital Differential Analyzer) line drawing with thickness
 void draw_line_f(canvas_t* canvas, float x0, float y0, float x1, float y1, float thickness) {
     if (!canvas || thickness <= 0.0f) return;
+    PROF_BEGIN(PROF_STAGE_RASTER);
+    PROF_COUNT(PROF_COUNTER_LINES_DRAWN, 1);
     
     float dx = x1 - x0;
     float dy = y1 - y0;
@@ -105,6 +419,7 @@ void draw_line_f(canvas_t* canvas, float x0, float y0, float x1, float y1, float
     int steps = (int)(fmax(fabs(dx), fabs(dy)) * 2); // Multiply by 2 for smoother lines
     if (steps == 0) {
         set_pixel_f(canvas, x0, y0, 1.0f);
+        PROF_END(PROF_STAGE_RASTER);
         return;
     }
     
@@ -113,50 +428,204 @@ void draw_line_f(canvas_t* canvas, float x0, float y0, float x1, float y1, float
     
     // Calculate perpendicular direction for thickness
     float length = sqrt(dx * dx + dy * dy);
-    if (length == 0) return;
+    if (length == 0) {
+        PROF_END(PROF_STAGE_RASTER);
+        return;
+    }
     
     float perp_x = -dy / length * thickness / 2.0f;
     float perp_y = dx / length * thickness / 2.0f;
+
+    // Per-line stamp: perpendicular offsets and falloff for each sample
+    int thickness_steps = (int)(thickness * 2) + 1;
+    float stamp_buffer[3 * FALLOFF_MAX_STEPS];
+    float* stamp = stamp_buffer;
+    if (thickness_steps > FALLOFF_MAX_STEPS) {
+        stamp = malloc(3 * thickness_steps * sizeof(float));
+        if (!stamp) {
+            PROF_END(PROF_STAGE_RASTER);
+            return;
+        }
+    }
+    float* offset_x = stamp;
+    float* offset_y = stamp + thickness_steps;
+    float* falloff = stamp + 2 * thickness_steps;
+
+    for (int t = 0; t < thickness_steps; t++) {
+        float t_ratio = falloff_ratio(t, thickness_steps);
+        offset_x[t] = perp_x * t_ratio * 2.0f;
+        offset_y[t] = perp_y * t_ratio * 2.0f;
+        falloff[t] = (thickness_steps <= FALLOFF_MAX_STEPS)
+            ? falloff_table[thickness_steps][t]
+            : (float)exp(-2.0f * t_ratio * t_ratio);
+    }
     
-    // Draw the line with thickness
-    for (int i = 0; i <= steps; i++) {
-        float x = x0 + i * x_step;
-        float y = y0 + i * y_step;
-        
-        // Draw thickness by drawing multiple pixels perpendicular to line direction
-        int thickness_steps = (int)(thickness * 2) + 1;
-        for (int t = 0; t < thickness_steps; t++) {
-            float t_ratio = (thickness_steps == 1) ? 0 : (float)t / (thickness_steps - 1) - 0.5f;
-            float px = x + perp_x * t_ratio * 2.0f;
-            float py = y + perp_y * t_ratio * 2.0f;
+    // Clip once per segment: skip samples whose stamp cannot reach the canvas.
+    // A stamp spans |perp| either side of the line and splats one pixel right
+    // and down; one more pixel of reach absorbs rounding.
+    int first = 0, last = steps;
+    clip_samples(x0, x_step, fabsf(perp_x) + 2.0f, 0, canvas->width, steps, &first, &last);
+    clip_samples(y0, y_step, fabsf(perp_y) + 2.0f, canvas->origin_y, canvas->height, steps, &first, &last);
+    
+    // Draw the line with thickness. Every splat of the clipped samples lands
+    // within thickness + 4 pixels of the canvas, so on canvases with a wide
+    // enough guard band the loops need no bounds checks; weights and clamping
+    // are the same as set_pixel_f. NaN or far-off endpoints defeat the clipping
+    // and stay on the checked path.
+    int guarded = (canvas->pixels || canvas->blocks) && thickness + 6.0f <= canvas->guard &&
+                  guarded_coord(x0) && guarded_coord(y0) && guarded_coord(x1) && guarded_coord(y1);
+    if (guarded && canvas->blocks) {
+        for (int i = first; i <= last; i++) {
+            float x = x0 + i * x_step;
+            float y = y0 + i * y_step;
+            for (int t = 0; t < thickness_steps; t++) {
+                float sx = x + offset_x[t];
+                float sy = y + offset_y[t];
+                int ix = floor_to_int(sx);
+                int iy = floor_to_int(sy);
+                block_splat(canvas, ix, iy - canvas->origin_y, sx - ix, sy - iy, falloff[t]);
+                PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, splat_pixels_inside(canvas, ix, iy - canvas->origin_y));
+            }
+        }
+    } else if (guarded) {
+        for (int i = first; i <= last; i++) {
+            float x = x0 + i * x_step;
+            float y = y0 + i * y_step;
+            for (int t = 0; t < thickness_steps; t++) {
+                float sx = x + offset_x[t];
+                float sy = y + offset_y[t];
+                int ix = floor_to_int(sx);
+                int iy = floor_to_int(sy);
+                float fx = sx - ix;
+                float fy = sy - iy;
+                float v = falloff[t];
+                float* top = canvas->pixels[iy - canvas->origin_y] + ix;
+                float* bottom = canvas->pixels[iy - canvas->origin_y + 1] + ix;
+                top[0] = clamp_one(top[0] + (1.0f - fx) * (1.0f - fy) * v);
+                top[1] = clamp_one(top[1] + fx * (1.0f - fy) * v);
+                bottom[0] = clamp_one(bottom[0] + (1.0f - fx) * fy * v);
+                bottom[1] = clamp_one(bottom[1] + fx * fy * v);
+                PROF_COUNT(PROF_COUNTER_PIXELS_WRITTEN, splat_pixels_inside(canvas, ix, iy - canvas->origin_y));
+            }
+        }
+    } else {
+        for (int i = first; i <= last; i++) {
+            float x = x0 + i * x_step;
+            float y = y0 + i * y_step;
             
-            // Use gaussian-like falloff for smoother thickness
-            float falloff = exp(-2.0f * t_ratio * t_ratio);
-            set_pixel_f(canvas, px, py, falloff);
+            // Draw thickness by stamping pixels perpendicular to line direction
+            for (int t = 0; t < thickness_steps; t++) {
+                set_pixel_f(canvas, x + offset_x[t], y + offset_y[t], falloff[t]);
+            }
         }
     }
+
+    if (stamp != stamp_buffer) free(stamp);
+    PROF_END(PROF_STAGE_RASTER);
 }
 
 // Save canvas as PGM (Portable GrayMap) format for visualization
-void canvas_save_pgm(canvas_t* canvas, const char* filename) {
-    if (!canvas || !filename) return;
+int canvas_save_pgm(canvas_t* canvas, const char* filename) {
+    if (!canvas || !filename) return -1;
     
     FILE* file = fopen(filename, "w");
-    if (!file) return;
+    if (!file) return -1;
     
-    fprintf(file, "P2\n");
-    fprintf(file, "%d %d\n", canvas->width, canvas->height);
-    fprintf(file, "255\n");
-    
-    for (int y = 0; y < canvas->height; y++) {
+    int failed = canvas_write_pgm(canvas, file, 0);
+    PROF_COUNT(PROF_COUNTER_BYTES_WRITTEN, ftell(file));
+    failed |= ferror(file);
+    failed |= fclose(file);
+    return failed ? -1 : 0;
+}
+
+// One row of a sparse canvas; untouched tiles are runs of "0 "
+static void write_sparse_row(const canvas_t* canvas, FILE* file, int y) {
+    static char zeros[2 * CANVAS_TILE_SIZE];
+    if (!zeros[0]) {
+        for (int i = 0; i < CANVAS_TILE_SIZE; i++) {
+            zeros[2 * i] = '0';
+            zeros[2 * i + 1] = ' ';
+        }
+    }
+
+    float* const* tiles = canvas->tiles + (size_t)(y >> CANVAS_TILE_SHIFT) * canvas->tiles_x;
+    int offset = (y & TILE_MASK) << CANVAS_TILE_SHIFT;
+    for (int tx = 0; tx < canvas->tiles_x; tx++) {
+        int x0 = tx << CANVAS_TILE_SHIFT;
+        int n = canvas->width - x0 < CANVAS_TILE_SIZE ? canvas->width - x0 : CANVAS_TILE_SIZE;
+        if (!tiles[tx]) {
+            fwrite(zeros, 2, n, file);
+            continue;
+        }
+        const float* row = tiles[tx] + offset;
+        for (int x = 0; x < n; x++) {
+            fprintf(file, "%d ", (int)(row[x] * 255));
+        }
+    }
+}
+
+// Rows of a dense canvas; blocked ones are gathered into row order first
+static int write_dense_rows(const canvas_t* canvas, FILE* file, int rows) {
+    float* scratch = NULL;
+    if (!canvas->pixels && !(scratch = malloc(canvas->width * sizeof(float)))) return -1;
+    for (int y = 0; y < rows; y++) {
+        const float* row = canvas_row(canvas, y, scratch);
         for (int x = 0; x < canvas->width; x++) {
-            int gray_value = (int)(canvas->pixels[y][x] * 255);
+            int gray_value = (int)(row[x] * 255);
             fprintf(file, "%d ", gray_value);
         }
         fprintf(file, "\n");
     }
+    free(scratch);
+    return 0;
+}
+
+void canvas_write_pgm_header(FILE* file, int width, int height) {
+    fprintf(file, "P2\n");
+    fprintf(file, "%d %d\n", width, height);
+    fprintf(file, "255\n");
+}
+
+int canvas_write_pgm_rows(const canvas_t* canvas, FILE* file, int rows) {
+    if (!canvas || !file || rows < 0 || rows > canvas->height) return -1;
+    PROF_BEGIN(PROF_STAGE_EXPORT);
+    if (canvas->tiles) {
+        for (int y = 0; y < rows; y++) {
+            write_sparse_row(canvas, file, y);
+            fprintf(file, "\n");
+        }
+    } else if (write_dense_rows(canvas, file, rows) != 0) {
+        PROF_END(PROF_STAGE_EXPORT);
+        return -1;
+    }
+    PROF_END(PROF_STAGE_EXPORT);
+    return ferror(file) ? -1 : 0;
+}
+
+int canvas_write_pgm(canvas_t* canvas, FILE* file, int release) {
+    if (!canvas || !file) return -1;
+    PROF_BEGIN(PROF_STAGE_EXPORT);
+    
+    canvas_write_pgm_header(file, canvas->width, canvas->height);
+    
+    if (canvas->tiles) {
+        // Band by band: a band is one row of tiles, freed after writing if asked
+        for (int ty = 0; ty < canvas->tiles_y; ty++) {
+            int y_end = (ty + 1) << CANVAS_TILE_SHIFT;
+            if (y_end > canvas->height) y_end = canvas->height;
+            for (int y = ty << CANVAS_TILE_SHIFT; y < y_end; y++) {
+                write_sparse_row(canvas, file, y);
+                fprintf(file, "\n");
+            }
+            if (release) free_tiles(canvas, ty, 1);
+        }
+    } else if (write_dense_rows(canvas, file, canvas->height) != 0) {
+        PROF_END(PROF_STAGE_EXPORT);
+        return -1;
+    }
     
-    fclose(file);
+    PROF_END(PROF_STAGE_EXPORT);
+    return ferror(file) ? -1 : 0;
 }
 
 void draw_circle(canvas_t* canvas, int center_x, int center_y, int radius, uint8_t intensity) {
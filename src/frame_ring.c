@@ -0,0 +1,419 @@
+// frame_ring.c
+#define _POSIX_C_SOURCE 200112L
+
+#include "frame_ring.h"
+#include <stdio.h>
+#include <string.h>
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(FRAME_RING_NO_SHM)
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#define FRAME_RING_SHM
+#endif
+
+static const char ring_magic[8] = "T3DRING";
+
+// Header and slot headers keep head, tail and the pixels on separate cache lines
+typedef char ring_header_size_check[sizeof(frame_ring_header_t) == 256 ? 1 : -1];
+typedef char ring_slot_size_check[sizeof(frame_ring_slot_t) == 64 ? 1 : -1];
+
+#ifdef FRAME_RING_SHM
+
+#define RING_MAX_SLOTS 1024
+#define RING_ATTACH_WAIT_MS 1000    // how long to wait for another creator to finish
+
+static void ring_pause(void) {
+    struct timespec ts = { 0, 100000 };  // 0.1 ms
+    nanosleep(&ts, NULL);
+}
+
+static frame_ring_slot_t* ring_slot(const frame_ring_t* ring, uint64_t position) {
+    frame_ring_header_t* h = ring->header;
+    size_t index = (size_t)(position & (h->slot_count - 1));
+    return (frame_ring_slot_t*)((uint8_t*)h + sizeof(frame_ring_header_t) + index * h->slot_stride);
+}
+
+static size_t ring_map_size(const frame_ring_header_t* h) {
+    return sizeof(frame_ring_header_t) + (size_t)h->slot_count * h->slot_stride;
+}
+
+// 1 if no process has this pid any more
+static int pid_gone(uint32_t pid) {
+    return kill((pid_t)pid, 0) != 0 && errno == ESRCH;
+}
+
+// Map an open shared-memory descriptor, which the ring keeps
+static frame_ring_t* ring_map(const char* name, int fd, size_t size) {
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    frame_ring_t* ring = calloc(1, sizeof(frame_ring_t));
+    if (!ring) {
+        munmap(base, size);
+        close(fd);
+        return NULL;
+    }
+    ring->header = base;
+    ring->map_size = size;
+    ring->fd = fd;
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+    return ring;
+}
+
+// Drop a mapping without touching the producer or consumer registrations
+static void ring_unmap(frame_ring_t* ring) {
+    munmap(ring->header, ring->map_size);
+    close(ring->fd);
+    free(ring);
+}
+
+// Serializes joining, leaving and replacing a ring across processes
+static void ring_lock(const frame_ring_t* ring, short type) {
+    struct flock lock = { 0 };
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(ring->fd, F_SETLKW, &lock) != 0 && errno == EINTR) {
+    }
+}
+
+// Remove the name if it still refers to this ring and not to a newer one
+// created after this ring closed. Call with the lock held, as the last step:
+// closing the probe descriptor drops this process's locks on the object.
+static void ring_unlink(const frame_ring_t* ring) {
+    int fd = shm_open(ring->name, O_RDONLY, 0);
+    if (fd < 0) return;
+    struct stat ours, named;
+    if (fstat(ring->fd, &ours) == 0 && fstat(fd, &named) == 0 &&
+        ours.st_dev == named.st_dev && ours.st_ino == named.st_ino) {
+        shm_unlink(ring->name);
+    }
+    close(fd);
+}
+
+// One producer fewer; the last one closes the ring. Call with the lock held.
+static void ring_leave(const frame_ring_t* ring) {
+    frame_ring_header_t* h = ring->header;
+    if (__atomic_sub_fetch(&h->producers, 1, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_store_n(&h->closed, 1, __ATOMIC_RELEASE);
+        ring_unlink(ring);
+    }
+}
+
+// List this process as a producer; -1 if the table is full
+static int ring_join(frame_ring_t* ring) {
+    frame_ring_header_t* h = ring->header;
+    for (int i = 0; i < FRAME_RING_MAX_PRODUCERS; i++) {
+        uint32_t none = 0;
+        if (__atomic_compare_exchange_n(&h->producer_pids[i], &none, (uint32_t)getpid(), 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            ring->producer = 1;
+            ring->producer_entry = i;
+            __atomic_fetch_add(&h->producers, 1, __ATOMIC_ACQ_REL);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Forget producers that exited without closing
+static void ring_reap(const frame_ring_t* ring) {
+    frame_ring_header_t* h = ring->header;
+    for (int i = 0; i < FRAME_RING_MAX_PRODUCERS; i++) {
+        uint32_t pid = __atomic_load_n(&h->producer_pids[i], __ATOMIC_ACQUIRE);
+        if (pid == 0 || !pid_gone(pid)) continue;
+        ring_lock(ring, F_WRLCK);
+        if (__atomic_compare_exchange_n(&h->producer_pids[i], &pid, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            ring_leave(ring);
+        }
+        ring_lock(ring, F_UNLCK);
+    }
+}
+
+// Wait until the creator has published the header, then check it
+static int ring_ready(const frame_ring_header_t* h) {
+    for (int waited = 0; waited < RING_ATTACH_WAIT_MS * 10; waited++) {
+        if (__atomic_load_n(&h->version, __ATOMIC_ACQUIRE) == FRAME_RING_VERSION &&
+            memcmp(h->magic, ring_magic, sizeof(ring_magic)) == 0) {
+            return 1;
+        }
+        ring_pause();
+    }
+    return 0;
+}
+
+// Map an existing ring and check its header against the object size
+static frame_ring_t* ring_attach(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+
+    // A creator that has just made the object may not have sized it yet
+    struct stat st;
+    int ok = fstat(fd, &st) == 0;
+    for (int waited = 0; ok && (size_t)st.st_size < sizeof(frame_ring_header_t); waited++) {
+        if (waited == RING_ATTACH_WAIT_MS * 10) ok = 0;
+        ring_pause();
+        ok = ok && fstat(fd, &st) == 0;
+    }
+    if (!ok) {
+        printf("ERROR: %s is not a frame ring\n", name);
+        close(fd);
+        return NULL;
+    }
+    frame_ring_t* ring = ring_map(name, fd, (size_t)st.st_size);
+    if (!ring) return NULL;
+    if (!ring_ready(ring->header) || ring_map_size(ring->header) != ring->map_size) {
+        printf("ERROR: %s is not a frame ring of this version\n", name);
+        ring_unmap(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+frame_ring_t* frame_ring_create(const char* name, int width, int height, int slot_count) {
+    if (!name || width <= 0 || height <= 0 || slot_count < 1 || slot_count > RING_MAX_SLOTS ||
+        (slot_count & (slot_count - 1)) != 0 || (size_t)width > SIZE_MAX / RING_MAX_SLOTS / (size_t)height) {
+        printf("ERROR: Bad frame ring parameters\n");
+        return NULL;
+    }
+    size_t stride = (sizeof(frame_ring_slot_t) + (size_t)width * height + 63) & ~(size_t)63;
+    size_t size = sizeof(frame_ring_header_t) + stride * slot_count;
+
+    frame_ring_t* ring = NULL;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        if (ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            shm_unlink(name);
+            printf("ERROR: Cannot size frame ring %s\n", name);
+            return NULL;
+        }
+        ring = ring_map(name, fd, size);
+        if (!ring) {
+            shm_unlink(name);
+            printf("ERROR: Cannot map frame ring %s\n", name);
+            return NULL;
+        }
+
+        // Fresh pages are zero; fill in the layout and free every slot. Nobody
+        // can join before the version is stored, so no lock is needed yet.
+        frame_ring_header_t* h = ring->header;
+        h->width = (uint32_t)width;
+        h->height = (uint32_t)height;
+        h->slot_count = (uint32_t)slot_count;
+        h->slot_stride = stride;
+        for (int i = 0; i < slot_count; i++) ring_slot(ring, (uint64_t)i)->sequence = (uint64_t)i;
+        ring_join(ring);
+        memcpy(h->magic, ring_magic, sizeof(ring_magic));
+        __atomic_store_n(&h->version, FRAME_RING_VERSION, __ATOMIC_RELEASE);
+        return ring;
+    }
+    if (errno != EEXIST) {
+        printf("ERROR: Cannot create frame ring %s\n", name);
+        return NULL;
+    }
+
+    ring = ring_attach(name);
+    if (!ring) return NULL;
+    ring_reap(ring);
+    ring_lock(ring, F_WRLCK);
+    int closed = __atomic_load_n(&ring->header->closed, __ATOMIC_ACQUIRE);
+    if (closed) {
+        // Left over from a finished or crashed run: start a new ring under the name
+        ring_unlink(ring);
+    } else if (ring->header->width != (uint32_t)width || ring->header->height != (uint32_t)height) {
+        printf("ERROR: Frame ring %s exists with another frame size\n", name);
+    } else if (ring_join(ring) != 0) {
+        printf("ERROR: Frame ring %s has %d producers already\n", name, FRAME_RING_MAX_PRODUCERS);
+    }
+    ring_lock(ring, F_UNLCK);
+    if (ring->producer) return ring;
+    ring_unmap(ring);
+    return closed ? frame_ring_create(name, width, height, slot_count) : NULL;
+}
+
+frame_ring_t* frame_ring_open(const char* name) {
+    frame_ring_t* ring = name ? ring_attach(name) : NULL;
+    if (!ring) return NULL;
+
+    // The consumer field holds the consumer's pid so producers can tell when it died
+    uint32_t none = 0;
+    if (!__atomic_compare_exchange_n(&ring->header->consumer, &none, (uint32_t)getpid(), 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        printf("ERROR: Frame ring %s already has a consumer\n", name);
+        ring_unmap(ring);
+        return NULL;
+    }
+    ring->reading = __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+    return ring;
+}
+
+void frame_ring_close(frame_ring_t* ring) {
+    if (!ring) return;
+    frame_ring_header_t* h = ring->header;
+
+    if (ring->producer) {
+        ring_lock(ring, F_WRLCK);
+        __atomic_store_n(&h->producer_pids[ring->producer_entry], 0, __ATOMIC_RELEASE);
+        ring_leave(ring);
+        ring_lock(ring, F_UNLCK);
+    } else if (__atomic_load_n(&h->consumer, __ATOMIC_RELAXED) == (uint32_t)getpid()) {
+        if (ring->holding) frame_ring_release(ring);
+        __atomic_store_n(&h->consumer, 0, __ATOMIC_RELEASE);
+    }
+    ring_unmap(ring);
+}
+
+// 1 if a live consumer is attached; forgets one that exited without detaching
+static int ring_has_consumer(frame_ring_header_t* h) {
+    uint32_t pid = __atomic_load_n(&h->consumer, __ATOMIC_ACQUIRE);
+    if (pid == 0) return 0;
+    if (pid_gone(pid)) {
+        __atomic_compare_exchange_n(&h->consumer, &pid, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
+
+int frame_ring_publish(frame_ring_t* ring, const canvas_t* canvas, int frame) {
+    frame_ring_header_t* h = ring->header;
+    if (!canvas || (uint32_t)canvas->width != h->width || (uint32_t)canvas->height != h->height) return -1;
+    float* scratch = NULL;
+    if (!canvas->pixels && !(scratch = malloc(canvas->width * sizeof(float)))) return -1;
+
+    // Claim a position whose slot the consumer has handed back
+    uint64_t pos = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+    frame_ring_slot_t* slot;
+    for (;;) {
+        slot = ring_slot(ring, pos);
+        uint64_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int64_t lag = (int64_t)(seq - pos);
+        if (lag == 0) {
+            if (__atomic_compare_exchange_n(&h->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (lag < 0) {
+            // Full: the slot still holds the frame from one lap ago
+            if (!ring_has_consumer(h)) {
+                free(scratch);
+                return 1;
+            }
+            ring_pause();
+            pos = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&h->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    // The writer pid lets the consumer skip this slot if the process dies here
+    __atomic_store_n(&slot->writer, (uint32_t)getpid(), __ATOMIC_RELAXED);
+    slot->frame = frame;
+    uint8_t* out = (uint8_t*)(slot + 1);
+    for (int y = 0; y < canvas->height; y++) {
+        const float* row = canvas_row(canvas, y, scratch);
+        for (int x = 0; x < canvas->width; x++) {
+            float v = row[x];
+            *out++ = v <= 0.0f ? 0 : v >= 1.0f ? 255 : (uint8_t)(int)(v * 255);
+        }
+    }
+    __atomic_store_n(&slot->writer, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    free(scratch);
+    return 0;
+}
+
+const uint8_t* frame_ring_acquire(frame_ring_t* ring, int* frame) {
+    frame_ring_slot_t* slot = ring_slot(ring, ring->reading);
+    if (!ring->holding) {
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != ring->reading + 1) return NULL;
+        ring->holding = 1;
+    }
+    if (frame) *frame = slot->frame;
+    return (const uint8_t*)(slot + 1);
+}
+
+void frame_ring_release(frame_ring_t* ring) {
+    if (!ring->holding) return;
+    frame_ring_header_t* h = ring->header;
+    __atomic_store_n(&ring_slot(ring, ring->reading)->sequence, ring->reading + h->slot_count, __ATOMIC_RELEASE);
+    ring->reading++;
+    ring->holding = 0;
+    __atomic_store_n(&h->tail, ring->reading, __ATOMIC_RELEASE);
+}
+
+int frame_ring_finished(frame_ring_t* ring) {
+    frame_ring_header_t* h = ring->header;
+    frame_ring_slot_t* slot = ring_slot(ring, ring->reading);
+    if (ring->holding) return 0;
+
+    // Claimed but not published, by a producer that no longer exists: hand
+    // the slot back as if it had been read
+    uint64_t seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    uint32_t writer = __atomic_load_n(&slot->writer, __ATOMIC_ACQUIRE);
+    if (seq == ring->reading && __atomic_load_n(&h->head, __ATOMIC_ACQUIRE) > ring->reading &&
+        writer != 0 && pid_gone(writer) &&
+        __atomic_compare_exchange_n(&slot->writer, &writer, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        ring->holding = 1;
+        frame_ring_release(ring);
+        return 0;
+    }
+
+    if (!__atomic_load_n(&h->closed, __ATOMIC_ACQUIRE)) {
+        ring_reap(ring);
+        if (!__atomic_load_n(&h->closed, __ATOMIC_ACQUIRE)) return 0;
+    }
+
+    // Closed, so no producer is left to publish: a claimed slot still empty
+    // was abandoned, even by one that died before recording its pid. Skip it
+    // and keep draining the frames published after it.
+    seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (seq == ring->reading && __atomic_load_n(&h->head, __ATOMIC_ACQUIRE) > ring->reading) {
+        __atomic_store_n(&slot->writer, 0, __ATOMIC_RELAXED);
+        ring->holding = 1;
+        frame_ring_release(ring);
+        return 0;
+    }
+    return seq != ring->reading + 1;
+}
+
+#else  // no POSIX shared memory
+
+frame_ring_t* frame_ring_create(const char* name, int width, int height, int slot_count) {
+    (void)name; (void)width; (void)height; (void)slot_count; (void)ring_magic;
+    printf("ERROR: Frame rings need POSIX shared memory\n");
+    return NULL;
+}
+
+frame_ring_t* frame_ring_open(const char* name) {
+    (void)name;
+    return NULL;
+}
+
+void frame_ring_close(frame_ring_t* ring) {
+    (void)ring;
+}
+
+int frame_ring_publish(frame_ring_t* ring, const canvas_t* canvas, int frame) {
+    (void)ring; (void)canvas; (void)frame;
+    return -1;
+}
+
+const uint8_t* frame_ring_acquire(frame_ring_t* ring, int* frame) {
+    (void)ring; (void)frame;
+    return NULL;
+}
+
+void frame_ring_release(frame_ring_t* ring) {
+    (void)ring;
+}
+
+int frame_ring_finished(frame_ring_t* ring) {
+    (void)ring;
+    return 1;
+}
+
+#endif
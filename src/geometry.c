@@ -0,0 +1,409 @@
+// geometry.c
+#include "geometry.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Edge hash map ---
+
+// Open addressing from a vertex pair to an index. Sized up front for a load of
+// at most 1/2, so every lookup is O(1) and construction stays linear.
+typedef struct {
+    uint64_t key;           // 0 is empty
+    int value;
+} edge_entry_t;
+
+typedef struct {
+    edge_entry_t* entries;  // key and value side by side: one miss per probe
+    size_t mask;
+} edge_map_t;
+
+static void edge_map_free(edge_map_t* map) {
+    free(map->entries);
+}
+
+static int edge_map_init(edge_map_t* map, size_t max_entries) {
+    size_t capacity = 16;
+    while (capacity < max_entries * 2) capacity *= 2;
+    map->entries = calloc(capacity, sizeof(edge_entry_t));
+    map->mask = capacity - 1;
+    return map->entries ? 0 : -1;
+}
+
+// Key of the undirected edge a-b; never 0
+static uint64_t edge_key(int a, int b) {
+    uint32_t lo = (uint32_t)(a < b ? a : b), hi = (uint32_t)(a < b ? b : a);
+    return ((uint64_t)lo + 1) << 32 | hi;
+}
+
+// Slot holding key, or the empty slot where it belongs
+static size_t edge_map_slot(const edge_map_t* map, uint64_t key) {
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & map->mask;
+    while (map->entries[slot].key && map->entries[slot].key != key) slot = (slot + 1) & map->mask;
+    return slot;
+}
+
+static void edge_map_put(edge_map_t* map, int a, int b, int value) {
+    uint64_t key = edge_key(a, b);
+    size_t slot = edge_map_slot(map, key);
+    map->entries[slot].key = key;
+    map->entries[slot].value = value;
+}
+
+// Value stored for a-b, or -1
+static int edge_map_get(const edge_map_t* map, int a, int b) {
+    size_t slot = edge_map_slot(map, edge_key(a, b));
+    return map->entries[slot].key ? map->entries[slot].value : -1;
+}
+
+// --- Construction helpers ---
+
+static geometry_t* geometry_alloc(int vert_count, int max_edges, int triangle_count) {
+    geometry_t* g = calloc(1, sizeof(geometry_t));
+    if (!g) return NULL;
+    g->vert_count = vert_count;
+    g->triangle_count = triangle_count;
+    g->verts = malloc((vert_count > 0 ? vert_count : 1) * sizeof(vec3_t));
+    g->edges = malloc((max_edges > 0 ? max_edges : 1) * sizeof(*g->edges));
+    if (triangle_count > 0) g->triangles = malloc(triangle_count * sizeof(*g->triangles));
+    if (!g->verts || !g->edges || (triangle_count > 0 && !g->triangles)) {
+        geometry_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+// Append a-b unless an edge between them was added before
+static void add_unique_edge(geometry_t* g, edge_map_t* seen, int a, int b) {
+    uint64_t key = edge_key(a, b);
+    size_t slot = edge_map_slot(seen, key);
+    if (seen->entries[slot].key) return;
+    seen->entries[slot].key = key;
+    seen->entries[slot].value = g->edge_count;
+    g->edges[g->edge_count][0] = a;
+    g->edges[g->edge_count][1] = b;
+    g->edge_count++;
+}
+
+// Outlines of polygon_count closed polygons -> unique edges in first-use
+// order. g->edges must have room for polygon_count * corners; the slack is
+// released afterwards.
+static int build_edges(geometry_t* g, const int* polygons, int polygon_count, int corners) {
+    edge_map_t seen;
+    if (edge_map_init(&seen, (size_t)polygon_count * corners) != 0) return -1;
+    g->edge_count = 0;
+    for (int p = 0; p < polygon_count; p++) {
+        const int* v = polygons + (size_t)p * corners;
+        for (int k = 0; k < corners; k++) add_unique_edge(g, &seen, v[k], v[(k + 1) % corners]);
+    }
+    edge_map_free(&seen);
+
+    int (*edges)[2] = realloc(g->edges, (g->edge_count > 0 ? g->edge_count : 1) * sizeof(*edges));
+    if (edges) g->edges = edges;
+    return 0;
+}
+
+static vec3_t unit_vector(float x, float y, float z) {
+    float inv = 1.0f / sqrtf(x * x + y * y + z * z);
+    return vec3_from_cartesian(x * inv, y * inv, z * inv);
+}
+
+// --- Solids ---
+
+geometry_t* geometry_tetrahedron(void) {
+    static const int faces[4][3] = { {0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2} };
+    static const int edges[6][2] = { {0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3} };
+    geometry_t* g = geometry_alloc(4, 6, 4);
+    if (!g) return NULL;
+
+    float a = 1.0f / sqrtf(3.0f);
+    g->verts[0] = vec3_from_cartesian( a,  a,  a);
+    g->verts[1] = vec3_from_cartesian(-a, -a,  a);
+    g->verts[2] = vec3_from_cartesian(-a,  a, -a);
+    g->verts[3] = vec3_from_cartesian( a, -a, -a);
+    memcpy(g->triangles, faces, sizeof(faces));
+    memcpy(g->edges, edges, sizeof(edges));
+    g->edge_count = 6;
+    return g;
+}
+
+geometry_t* geometry_cube(void) {
+    static const int edges[12][2] = {
+        {0, 1}, {1, 2}, {2, 3}, {3, 0},  // bottom face
+        {4, 5}, {5, 6}, {6, 7}, {7, 4},  // top face
+        {0, 4}, {1, 5}, {2, 6}, {3, 7}   // vertical edges
+    };
+    geometry_t* g = geometry_alloc(8, 12, 0);
+    if (!g) return NULL;
+
+    g->verts[0] = vec3_from_cartesian(-1.0f, -1.0f, -1.0f);
+    g->verts[1] = vec3_from_cartesian( 1.0f, -1.0f, -1.0f);
+    g->verts[2] = vec3_from_cartesian( 1.0f,  1.0f, -1.0f);
+    g->verts[3] = vec3_from_cartesian(-1.0f,  1.0f, -1.0f);
+    g->verts[4] = vec3_from_cartesian(-1.0f, -1.0f,  1.0f);
+    g->verts[5] = vec3_from_cartesian( 1.0f, -1.0f,  1.0f);
+    g->verts[6] = vec3_from_cartesian( 1.0f,  1.0f,  1.0f);
+    g->verts[7] = vec3_from_cartesian(-1.0f,  1.0f,  1.0f);
+    memcpy(g->edges, edges, sizeof(edges));
+    g->edge_count = 12;
+    return g;
+}
+
+static geometry_t* geometry_icosahedron(void) {
+    static const int faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+        {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+    };
+    geometry_t* g = geometry_alloc(12, 60, 20);
+    if (!g) return NULL;
+
+    // Corners of three golden rectangles
+    float phi = (1.0f + sqrtf(5.0f)) / 2.0f;
+    g->verts[0]  = unit_vector(-1.0f,  phi,  0.0f);
+    g->verts[1]  = unit_vector( 1.0f,  phi,  0.0f);
+    g->verts[2]  = unit_vector(-1.0f, -phi,  0.0f);
+    g->verts[3]  = unit_vector( 1.0f, -phi,  0.0f);
+    g->verts[4]  = unit_vector( 0.0f, -1.0f,  phi);
+    g->verts[5]  = unit_vector( 0.0f,  1.0f,  phi);
+    g->verts[6]  = unit_vector( 0.0f, -1.0f, -phi);
+    g->verts[7]  = unit_vector( 0.0f,  1.0f, -phi);
+    g->verts[8]  = unit_vector( phi,  0.0f, -1.0f);
+    g->verts[9]  = unit_vector( phi,  0.0f,  1.0f);
+    g->verts[10] = unit_vector(-phi,  0.0f, -1.0f);
+    g->verts[11] = unit_vector(-phi,  0.0f,  1.0f);
+    memcpy(g->triangles, faces, sizeof(faces));
+    if (build_edges(g, &g->triangles[0][0], 20, 3) != 0) {
+        geometry_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+geometry_t* geometry_subdivide(const geometry_t* solid) {
+    if (!solid || !solid->triangles) return NULL;
+    if (solid->triangle_count > (INT32_MAX / 12) || solid->vert_count > INT32_MAX - solid->edge_count) return NULL;
+
+    int tri_count = solid->triangle_count * 4;
+    geometry_t* g = geometry_alloc(solid->vert_count + solid->edge_count,
+                                   solid->edge_count * 2 + solid->triangle_count * 3, tri_count);
+    edge_map_t midpoints;
+    if (!g || edge_map_init(&midpoints, solid->edge_count) != 0) {
+        geometry_destroy(g);
+        return NULL;
+    }
+
+    // Old vertices keep their indices; edge i gets midpoint vert_count + i and
+    // is split in two halves
+    memcpy(g->verts, solid->verts, solid->vert_count * sizeof(vec3_t));
+    for (int i = 0; i < solid->edge_count; i++) {
+        int from = solid->edges[i][0], to = solid->edges[i][1], mid = solid->vert_count + i;
+        vec3_t a = solid->verts[from], b = solid->verts[to];
+        g->verts[mid] = unit_vector(a.x + b.x, a.y + b.y, a.z + b.z);
+        edge_map_put(&midpoints, from, to, mid);
+        g->edges[2 * i][0] = from;
+        g->edges[2 * i][1] = mid;
+        g->edges[2 * i + 1][0] = mid;
+        g->edges[2 * i + 1][1] = to;
+    }
+
+    // Each triangle adds the three edges of its inner triangle; no edge is
+    // produced twice, so unlike build_edges this needs no second hash pass
+    g->edge_count = solid->edge_count * 2;
+    int ok = 1;
+    for (int t = 0; t < solid->triangle_count && ok; t++) {
+        int a = solid->triangles[t][0], b = solid->triangles[t][1], c = solid->triangles[t][2];
+        int ab = edge_map_get(&midpoints, a, b);
+        int bc = edge_map_get(&midpoints, b, c);
+        int ca = edge_map_get(&midpoints, c, a);
+        ok = ab >= 0 && bc >= 0 && ca >= 0;
+        int (*out)[3] = &g->triangles[t * 4];
+        out[0][0] = a;  out[0][1] = ab; out[0][2] = ca;
+        out[1][0] = ab; out[1][1] = b;  out[1][2] = bc;
+        out[2][0] = ca; out[2][1] = bc; out[2][2] = c;
+        out[3][0] = ab; out[3][1] = bc; out[3][2] = ca;
+        int (*inner)[2] = &g->edges[g->edge_count];
+        inner[0][0] = ab; inner[0][1] = bc;
+        inner[1][0] = bc; inner[1][1] = ca;
+        inner[2][0] = ca; inner[2][1] = ab;
+        g->edge_count += 3;
+    }
+    edge_map_free(&midpoints);
+
+    if (!ok) {
+        geometry_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+geometry_t* geometry_truncate(const geometry_t* solid, float t) {
+    if (!solid || !solid->triangles || !(t > 0.0f && t < 0.5f)) return NULL;
+    if (solid->edge_count > INT32_MAX / 2 || solid->triangle_count > INT32_MAX / 6) return NULL;
+
+    // Edge i is cut at 2i (near its first vertex) and 2i + 1 (near its second);
+    // the piece between the cuts stays an edge
+    geometry_t* g = geometry_alloc(solid->edge_count * 2, solid->edge_count + solid->triangle_count * 3, 0);
+    edge_map_t cuts;
+    if (!g || edge_map_init(&cuts, solid->edge_count) != 0) {
+        geometry_destroy(g);
+        return NULL;
+    }
+
+    for (int i = 0; i < solid->edge_count; i++) {
+        vec3_t a = solid->verts[solid->edges[i][0]], b = solid->verts[solid->edges[i][1]];
+        g->verts[2 * i]     = vec3_from_cartesian(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+        g->verts[2 * i + 1] = vec3_from_cartesian(b.x + (a.x - b.x) * t, b.y + (a.y - b.y) * t, b.z + (a.z - b.z) * t);
+        edge_map_put(&cuts, solid->edges[i][0], solid->edges[i][1], i);
+        g->edges[i][0] = 2 * i;
+        g->edges[i][1] = 2 * i + 1;
+    }
+    g->edge_count = solid->edge_count;
+
+    // Each triangle corner is cut off by an edge joining the cuts on the two
+    // triangle edges that meet there; together these outline the cut-off faces
+    int ok = 1;
+    for (int f = 0; f < solid->triangle_count && ok; f++) {
+        int near[3][2];     // cut on triangle edge k near its start / its end
+        for (int k = 0; k < 3 && ok; k++) {
+            int from = solid->triangles[f][k], to = solid->triangles[f][(k + 1) % 3];
+            int e = edge_map_get(&cuts, from, to);
+            ok = e >= 0;
+            near[k][0] = (ok && solid->edges[e][0] == from) ? 2 * e : 2 * e + 1;
+            near[k][1] = near[k][0] ^ 1;
+        }
+        for (int k = 0; k < 3 && ok; k++) {
+            g->edges[g->edge_count][0] = near[k][1];
+            g->edges[g->edge_count][1] = near[(k + 1) % 3][0];
+            g->edge_count++;
+        }
+    }
+    edge_map_free(&cuts);
+
+    if (!ok) {
+        geometry_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+geometry_t* geometry_icosphere(int subdivisions) {
+    if (subdivisions < 0 || subdivisions > GEOMETRY_MAX_SUBDIVISIONS) return NULL;
+    geometry_t* g = geometry_icosahedron();
+    for (int level = 0; level < subdivisions && g; level++) {
+        geometry_t* finer = geometry_subdivide(g);
+        geometry_destroy(g);
+        g = finer;
+    }
+    return g;
+}
+
+geometry_t* geometry_truncated_icosphere(int subdivisions) {
+    geometry_t* sphere = geometry_icosphere(subdivisions);
+    geometry_t* g = geometry_truncate(sphere, 1.0f / 3.0f);
+    geometry_destroy(sphere);
+    return g;
+}
+
+geometry_t* geometry_grid(int columns, int rows, float spacing) {
+    if (columns < 0 || rows < 0 || columns >= 46340 || rows >= 46340) return NULL;
+    int across = columns + 1, down = rows + 1;
+    geometry_t* g = geometry_alloc(across * down, columns * down + rows * across, 0);
+    if (!g) return NULL;
+
+    float x0 = -0.5f * columns * spacing, y0 = -0.5f * rows * spacing;
+    for (int y = 0; y < down; y++) {
+        for (int x = 0; x < across; x++) {
+            int v = y * across + x;
+            g->verts[v] = vec3_from_cartesian(x0 + x * spacing, y0 + y * spacing, 0.0f);
+            if (x + 1 < across) { g->edges[g->edge_count][0] = v; g->edges[g->edge_count][1] = v + 1; g->edge_count++; }
+            if (y + 1 < down) { g->edges[g->edge_count][0] = v; g->edges[g->edge_count][1] = v + across; g->edge_count++; }
+        }
+    }
+    return g;
+}
+
+void geometry_destroy(geometry_t* geometry) {
+    if (!geometry) return;
+    free(geometry->verts);
+    free(geometry->edges);
+    free(geometry->triangles);
+    free(geometry);
+}
+
+// --- Memoization ---
+
+typedef enum {
+    CACHED_ICOSPHERE,
+    CACHED_TRUNCATED_ICOSPHERE,
+    CACHED_GRID
+} cached_kind_t;
+
+typedef struct geometry_cache_entry {
+    cached_kind_t kind;
+    int a, b;               // subdivisions, or columns and rows
+    float spacing;
+    geometry_t* geometry;
+    struct geometry_cache_entry* next;
+} geometry_cache_entry_t;
+
+static geometry_cache_entry_t* g_geometry_cache;
+
+static const geometry_t* cache_find(cached_kind_t kind, int a, int b, float spacing) {
+    for (geometry_cache_entry_t* e = g_geometry_cache; e; e = e->next) {
+        if (e->kind == kind && e->a == a && e->b == b && e->spacing == spacing) return e->geometry;
+    }
+    return NULL;
+}
+
+// Takes ownership of geometry (freed if it cannot be stored)
+static const geometry_t* cache_store(cached_kind_t kind, int a, int b, float spacing, geometry_t* geometry) {
+    geometry_cache_entry_t* e = geometry ? malloc(sizeof(*e)) : NULL;
+    if (!e) {
+        geometry_destroy(geometry);
+        return NULL;
+    }
+    e->kind = kind;
+    e->a = a;
+    e->b = b;
+    e->spacing = spacing;
+    e->geometry = geometry;
+    e->next = g_geometry_cache;
+    g_geometry_cache = e;
+    return geometry;
+}
+
+const geometry_t* geometry_icosphere_cached(int subdivisions) {
+    if (subdivisions < 0 || subdivisions > GEOMETRY_MAX_SUBDIVISIONS) return NULL;
+    const geometry_t* g = cache_find(CACHED_ICOSPHERE, subdivisions, 0, 0.0f);
+    if (g) return g;
+
+    if (subdivisions == 0) return cache_store(CACHED_ICOSPHERE, 0, 0, 0.0f, geometry_icosahedron());
+    const geometry_t* coarser = geometry_icosphere_cached(subdivisions - 1);
+    return coarser ? cache_store(CACHED_ICOSPHERE, subdivisions, 0, 0.0f, geometry_subdivide(coarser)) : NULL;
+}
+
+const geometry_t* geometry_truncated_icosphere_cached(int subdivisions) {
+    const geometry_t* g = cache_find(CACHED_TRUNCATED_ICOSPHERE, subdivisions, 0, 0.0f);
+    if (g) return g;
+
+    const geometry_t* sphere = geometry_icosphere_cached(subdivisions);
+    if (!sphere) return NULL;
+    return cache_store(CACHED_TRUNCATED_ICOSPHERE, subdivisions, 0, 0.0f, geometry_truncate(sphere, 1.0f / 3.0f));
+}
+
+const geometry_t* geometry_grid_cached(int columns, int rows, float spacing) {
+    const geometry_t* g = cache_find(CACHED_GRID, columns, rows, spacing);
+    if (g) return g;
+    return cache_store(CACHED_GRID, columns, rows, spacing, geometry_grid(columns, rows, spacing));
+}
+
+void geometry_cache_clear(void) {
+    while (g_geometry_cache) {
+        geometry_cache_entry_t* next = g_geometry_cache->next;
+        geometry_destroy(g_geometry_cache->geometry);
+        free(g_geometry_cache);
+        g_geometry_cache = next;
+    }
+}
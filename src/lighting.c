@@ -1,8 +1,15 @@
 // Corrected lighting.c implementation - Simple Lambert lighting for edges
 
 #include "lighting.h"
+#include "profiler.h"
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__SSE__) && !defined(MATH3D_SCALAR)
+#include <xmmintrin.h>
+#define LIGHTING_SSE 1
+#endif
 
 // Create a new light
 light_t light_create(vec3_t position, vec3_t color, float intensity) {
@@ -10,9 +17,36 @@ light_t light_create(vec3_t position, vec3_t color, float intensity) {
     light.position = position;
     light.color = color;
     light.intensity = intensity;
+    light.range = 0.0f;
+    return light;
+}
+
+// Create a point light with a finite influence radius
+light_t light_create_ranged(vec3_t position, vec3_t color, float intensity, float range) {
+    light_t light = light_create(position, color, intensity);
+    light.range = range;
     return light;
 }
 
+// True if the light is on and its range reaches the sphere (center, radius)
+static int light_reaches(const light_t* light, vec3f_t position, vec3f_t center, float radius) {
+    if (light->intensity == 0.0f) return 0;
+    if (light->range <= 0.0f) return 1;
+    float reach = light->range + radius;
+    vec3f_t d = vec3f_sub(position, center);
+    return vec3f_dot(d, d) <= reach * reach;
+}
+
+int lights_cull(const light_t* lights, int light_count, vec3f_t center, float radius, light_t* out) {
+    int kept = 0;
+    for (int i = 0; i < light_count; i++) {
+        if (light_reaches(&lights[i], vec3f_from_vec3(lights[i].position), center, radius)) {
+            out[kept++] = lights[i];
+        }
+    }
+    return kept;
+}
+
 // Calculate normalized vector
 vec3_t vec3_normalize(vec3_t v) {
     float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
@@ -25,33 +59,16 @@ float vec3_dot(vec3_t a, vec3_t b) {
     return a.x * b.x + a.y * b.y + a.z * b.z;
 }
 
-// Calculate edge direction vector
-vec3_t calculate_edge_direction(vec3_t edge_start, vec3_t edge_end) {
-    vec3_t edge_dir = vec3_from_cartesian(
-        edge_end.x - edge_start.x,
-        edge_end.y - edge_start.y,
-        edge_end.z - edge_start.z
-    );
-    return vec3_normalize(edge_dir);
+// Edge midpoint on the lean cartesian type (no spherical updates)
+static vec3f_t vmid(vec3_t a, vec3_t b) {
+    vec3f_t r = { 0.5f * (a.x + b.x), 0.5f * (a.y + b.y), 0.5f * (a.z + b.z) };
+    return r;
 }
 
-
-static vec3_t vsub(vec3_t a, vec3_t b) {
-    return vec3_from_cartesian(a.x - b.x, a.y - b.y, a.z - b.z);
-}
-static vec3_t vmul(vec3_t v, float s) {
-    return vec3_from_cartesian(v.x * s, v.y * s, v.z * s);
-}
-static float vdot(vec3_t a, vec3_t b) {
-    return a.x * b.x + a.y * b.y + a.z * b.z;
-}
-static float vlen(vec3_t v) {
-    return sqrtf(vdot(v, v));
-}
-static vec3_t vnorm(vec3_t v) {
-    float L = vlen(v);
-    if (L < 1e-6f) return vec3_from_cartesian(0, 0, 0);
-    return vmul(v, 1.0f / L);
+// Calculate edge direction vector
+vec3_t calculate_edge_direction(vec3_t edge_start, vec3_t edge_end) {
+    vec3f_t edge_dir = vec3f_normalize(vec3f_sub(vec3f_from_vec3(edge_end), vec3f_from_vec3(edge_start)));
+    return vec3_from_vec3f(edge_dir);
 }
 
 
@@ -86,21 +103,23 @@ static vec3_t vnorm(vec3_t v) {
 
 
 float calculate_edge_lighting(vec3_t v0, vec3_t v1, light_t* lights, int light_count) {
+    PROF_BEGIN(PROF_STAGE_LIGHTING);
+
     // Midpoint of the edge
-    vec3_t midpoint = vec3_from_cartesian(
-        0.5f * (v0.x + v1.x),
-        0.5f * (v0.y + v1.y),
-        0.5f * (v0.z + v1.z)
-    );
+    vec3f_t midpoint = vmid(v0, v1);
 
     // Use midpoint as approximate normal (assuming vertices centered around origin)
-    vec3_t face_normal = vnorm(midpoint);
+    vec3f_t face_normal = vec3f_normalize(midpoint);
 
     float total_intensity = 0.0f;
 
     for (int i = 0; i < light_count; i++) {
-        vec3_t light_vec = vnorm(vsub(lights[i].position, midpoint));
-        float dot = vdot(face_normal, light_vec);
+        if (lights[i].intensity == 0.0f) continue;
+        vec3f_t to_light = vec3f_sub(vec3f_from_vec3(lights[i].position), midpoint);
+        if (lights[i].range > 0.0f && vec3f_dot(to_light, to_light) > lights[i].range * lights[i].range) continue;
+
+        vec3f_t light_vec = vec3f_normalize(to_light);
+        float dot = vec3f_dot(face_normal, light_vec);
         if (dot > 0.0f) {
             total_intensity += dot * lights[i].intensity * 1.5f; // Amplify for soccer ball
         }
@@ -108,39 +127,169 @@ float calculate_edge_lighting(vec3_t v0, vec3_t v1, light_t* lights, int light_c
 
     // Clamp between 0 and 1
     if (total_intensity > 1.0f) total_intensity = 1.0f;
+    PROF_END(PROF_STAGE_LIGHTING);
     return total_intensity;
 }
 
 
+// Lights up to this count are staged on the stack, more are heap-allocated
+#define LIGHT_STACK_COUNT 16
+
+// Scalar Lambert term for one cached edge, same operation order as the SIMD lanes
+static float edge_lambert(const mesh_t* mesh, int e, const float* lx, const float* ly,
+                          const float* lz, const float* li, const float* lr2, int light_count) {
+    vec3f_t midpoint = vec3f_make(mesh->mid_x[e], mesh->mid_y[e], mesh->mid_z[e]);
+    vec3f_t face_normal = vec3f_make(mesh->normal_x[e], mesh->normal_y[e], mesh->normal_z[e]);
+    float total_intensity = 0.0f;
+
+    for (int i = 0; i < light_count; i++) {
+        vec3f_t to_light = vec3f_sub(vec3f_make(lx[i], ly[i], lz[i]), midpoint);
+        if (vec3f_dot(to_light, to_light) > lr2[i]) continue;
+
+        vec3f_t light_vec = vec3f_normalize(to_light);
+        float dot = vec3f_dot(face_normal, light_vec);
+        if (dot > 0.0f) {
+            total_intensity += dot * li[i] * 1.5f;
+        }
+    }
+    return (total_intensity > 1.0f) ? 1.0f : total_intensity;
+}
+
+#ifdef LIGHTING_SSE
+// Squared length of four vectors, summed in vec3f_dot order
+static __m128 length_sq4(__m128 x, __m128 y, __m128 z) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+}
+
+// Four-lane vec3f_normalize given the squared lengths: zero where the length is below 1e-6
+static void normalize4(__m128* x, __m128* y, __m128* z, __m128 len_sq) {
+    __m128 len = _mm_sqrt_ps(len_sq);
+    __m128 keep = _mm_cmpge_ps(len, _mm_set1_ps(1e-6f));
+    __m128 inv = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), len), keep);
+    *x = _mm_mul_ps(*x, inv);
+    *y = _mm_mul_ps(*y, inv);
+    *z = _mm_mul_ps(*z, inv);
+}
+#endif
+
+// Light every edge from the mesh's cached midpoints and normals, with light
+// positions (lx, ly, lz) already in the mesh's coordinate space and squared
+// ranges lr2 (infinite for unbounded lights)
+static void edges_lighting_cached(const mesh_t* mesh, const float* lx, const float* ly,
+                                  const float* lz, const float* li, const float* lr2,
+                                  int light_count, float* out_intensity) {
+    int e = 0;
+#ifdef LIGHTING_SSE
+    for (; e + 4 <= mesh->edge_count; e += 4) {
+        __m128 px = _mm_loadu_ps(&mesh->mid_x[e]);
+        __m128 py = _mm_loadu_ps(&mesh->mid_y[e]);
+        __m128 pz = _mm_loadu_ps(&mesh->mid_z[e]);
+        __m128 nx = _mm_loadu_ps(&mesh->normal_x[e]);
+        __m128 ny = _mm_loadu_ps(&mesh->normal_y[e]);
+        __m128 nz = _mm_loadu_ps(&mesh->normal_z[e]);
+
+        __m128 total = _mm_setzero_ps();
+        for (int i = 0; i < light_count; i++) {
+            __m128 vx = _mm_sub_ps(_mm_set1_ps(lx[i]), px);
+            __m128 vy = _mm_sub_ps(_mm_set1_ps(ly[i]), py);
+            __m128 vz = _mm_sub_ps(_mm_set1_ps(lz[i]), pz);
+            __m128 len_sq = length_sq4(vx, vy, vz);
+
+            // Skip the light for this group when all four edges are out of range
+            __m128 in_range = _mm_cmple_ps(len_sq, _mm_set1_ps(lr2[i]));
+            if (!_mm_movemask_ps(in_range)) continue;
+            normalize4(&vx, &vy, &vz, len_sq);
+
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, vx), _mm_mul_ps(ny, vy)), _mm_mul_ps(nz, vz));
+            __m128 term = _mm_mul_ps(_mm_mul_ps(dot, _mm_set1_ps(li[i])), _mm_set1_ps(1.5f));
+            __m128 lit = _mm_and_ps(_mm_cmpgt_ps(dot, _mm_setzero_ps()), in_range);
+            total = _mm_add_ps(total, _mm_and_ps(term, lit));
+        }
+        _mm_storeu_ps(&out_intensity[e], _mm_min_ps(total, _mm_set1_ps(1.0f)));
+    }
+#endif
+    for (; e < mesh->edge_count; e++) {
+        out_intensity[e] = edge_lambert(mesh, e, lx, ly, lz, li, lr2, light_count);
+    }
+}
+
+// Stage the lights that reach the mesh's bounding sphere as SoA (positions
+// optionally mapped through 'to_mesh'), then run the cached kernel
+static void edges_lighting(const mesh_t* mesh, const affine_t* to_mesh, const light_t* lights,
+                           int light_count, float* out_intensity) {
+    float stack[5 * LIGHT_STACK_COUNT];
+    float* soa = stack;
+    if (light_count > LIGHT_STACK_COUNT) {
+        soa = malloc(5 * light_count * sizeof(float));
+        if (!soa) {
+            // Unlit rather than uninitialised, as for a singular model transform
+            printf("ERROR: Failed to allocate light staging\n");
+            for (int e = 0; e < mesh->edge_count; e++) out_intensity[e] = 0.0f;
+            return;
+        }
+    }
+    float* lx = soa;
+    float* ly = soa + light_count;
+    float* lz = soa + 2 * light_count;
+    float* li = soa + 3 * light_count;
+    float* lr2 = soa + 4 * light_count;
+
+    int active = 0;
+    for (int i = 0; i < light_count; i++) {
+        vec3f_t p = vec3f_from_vec3(lights[i].position);
+        if (to_mesh) p = affine_transform_point(to_mesh, p);
+        if (!light_reaches(&lights[i], p, mesh->bound_center, mesh->bound_radius)) continue;
+
+        lx[active] = p.x;
+        ly[active] = p.y;
+        lz[active] = p.z;
+        li[active] = lights[i].intensity;
+        lr2[active] = (lights[i].range > 0.0f) ? lights[i].range * lights[i].range : INFINITY;
+        active++;
+    }
+    edges_lighting_cached(mesh, lx, ly, lz, li, lr2, active, out_intensity);
+
+    if (soa != stack) free(soa);
+}
+
+void calculate_edges_lighting(const mesh_t* mesh, const light_t* lights, int light_count, float* out_intensity) {
+    PROF_BEGIN(PROF_STAGE_LIGHTING);
+    edges_lighting(mesh, NULL, lights, light_count, out_intensity);
+    PROF_END(PROF_STAGE_LIGHTING);
+}
+
+void calculate_edges_lighting_model(const mesh_t* mesh, const affine_t* model, const light_t* lights,
+                                    int light_count, float* out_intensity) {
+    PROF_BEGIN(PROF_STAGE_LIGHTING);
+    // One inverse per object takes the lights into model space, where the cache lives
+    affine_t world_to_model;
+    if (affine_inverse(&world_to_model, model) == 0) {
+        edges_lighting(mesh, &world_to_model, lights, light_count, out_intensity);
+    } else {
+        for (int e = 0; e < mesh->edge_count; e++) out_intensity[e] = 0.0f;
+    }
+    PROF_END(PROF_STAGE_LIGHTING);
+}
+
 // Alternative implementation that considers both edge directions
 // (since edges can be viewed from either direction)
 float calculate_edge_lighting_bidirectional(vec3_t edge_start, vec3_t edge_end, light_t* lights, int light_count) {
     if (light_count == 0) return 0.1f;
     
     // Calculate edge direction
-    vec3_t edge_dir = calculate_edge_direction(edge_start, edge_end);
+    vec3f_t edge_dir = vec3f_normalize(vec3f_sub(vec3f_from_vec3(edge_end), vec3f_from_vec3(edge_start)));
     
     // Calculate edge midpoint
-    vec3_t edge_mid = vec3_from_cartesian(
-        (edge_start.x + edge_end.x) * 0.5f,
-        (edge_start.y + edge_end.y) * 0.5f,
-        (edge_start.z + edge_end.z) * 0.5f
-    );
+    vec3f_t edge_mid = vmid(edge_start, edge_end);
     
     float total_intensity = 0.0f;
     
     for (int i = 0; i < light_count; i++) {
-        vec3_t light_vec = vec3_from_cartesian(
-            lights[i].position.x - edge_mid.x,
-            lights[i].position.y - edge_mid.y,
-            lights[i].position.z - edge_mid.z
-        );
-        
-        vec3_t light_dir = vec3_normalize(light_vec);
+        vec3f_t light_dir = vec3f_normalize(vec3f_sub(vec3f_from_vec3(lights[i].position), edge_mid));
         
         // Consider both directions of the edge (absolute value)
         // This prevents edges from going completely dark when viewed from behind
-        float lambert = fabsf(vec3_dot(edge_dir, light_dir));
+        float lambert = fabsf(vec3f_dot(edge_dir, light_dir));
         
         total_intensity += lambert * lights[i].intensity;
     }
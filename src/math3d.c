@@ -2,6 +2,15 @@
 
 #include "math3d.h"
 
+#if defined(__SSE__) && !defined(MATH3D_SCALAR)
+#include <xmmintrin.h>
+#define MATH3D_SSE 1
+#endif
+#if defined(__AVX__) && !defined(MATH3D_SCALAR)
+#include <immintrin.h>
+#define MATH3D_AVX 1
+#endif
+
 // --- vec3 functions (unchanged) ---
 vec3_t vec3_from_cartesian(float x, float y, float z) {
     vec3_t v = { x, y, z };
@@ -85,88 +94,149 @@ void vec3_print_spherical(const vec3_t* v) {
     printf("Spherical: (r=%.3f, θ=%.3f rad, φ=%.3f rad)\n", v->r, v->theta, v->phi);
 }
 
-// --- mat4 functions ---
-
-mat4_t mat4_identity(void) {
-    mat4_t m = { 0 };
-    m.m[0] = 1.0f; m.m[5] = 1.0f; m.m[10] = 1.0f; m.m[15] = 1.0f;
-    return m;
-}
-
-mat4_t mat4_translate(float tx, float ty, float tz) {
-    mat4_t m = mat4_identity();
-    m.m[12] = tx;
-    m.m[13] = ty;
-    m.m[14] = tz;
-    return m;
-}
-
-mat4_t mat4_scale(float sx, float sy, float sz) {
-    mat4_t m = { 0 };
-    m.m[0] = sx;
-    m.m[5] = sy;
-    m.m[10] = sz;
-    m.m[15] = 1.0f;
-    return m;
-}
+// --- vec3f functions ---
 
-static mat4_t mat4_rotate_x(float angle) {
-    mat4_t m = mat4_identity();
-    float c = cosf(angle);
-    float s = sinf(angle);
-    m.m[5] = c;
-    m.m[6] = s;
-    m.m[9] = -s;
-    m.m[10] = c;
-    return m;
+vec3_t vec3_from_vec3f(vec3f_t v) {
+    return vec3_from_cartesian(v.x, v.y, v.z);
 }
 
-static mat4_t mat4_rotate_y(float angle) {
-    mat4_t m = mat4_identity();
-    float c = cosf(angle);
-    float s = sinf(angle);
-    m.m[0] = c;
-    m.m[2] = -s;
-    m.m[8] = s;
-    m.m[10] = c;
-    return m;
+spherical_t vec3f_to_spherical(vec3f_t v) {
+    spherical_t s;
+    s.r = vec3f_length(v);
+    s.theta = atan2f(v.y, v.x);
+    s.phi = (s.r == 0.0f) ? 0.0f : acosf(v.z / s.r);
+    return s;
 }
 
-static mat4_t mat4_rotate_z(float angle) {
-    mat4_t m = mat4_identity();
-    float c = cosf(angle);
-    float s = sinf(angle);
-    m.m[0] = c;
-    m.m[1] = s;
-    m.m[4] = -s;
-    m.m[5] = c;
-    return m;
+vec3f_t vec3f_from_spherical(spherical_t s) {
+    float sin_phi = sinf(s.phi);
+    return vec3f_make(s.r * sin_phi * cosf(s.theta),
+                      s.r * sin_phi * sinf(s.theta),
+                      s.r * cosf(s.phi));
 }
 
+// --- mat4 functions ---
 
-mat4_t mat4_multiply(mat4_t a, mat4_t b) {
-    mat4_t result = { 0 };
+void mat4_multiply_into(mat4_t* out, const mat4_t* a, const mat4_t* b) {
+#ifdef MATH3D_SSE
+    // Column j of the result is a linear combination of the columns of a
+    __m128 a0 = _mm_loadu_ps(&a->m[0]);
+    __m128 a1 = _mm_loadu_ps(&a->m[4]);
+    __m128 a2 = _mm_loadu_ps(&a->m[8]);
+    __m128 a3 = _mm_loadu_ps(&a->m[12]);
+    __m128 col[4];
+    for (int c = 0; c < 4; c++) {
+        const float* bc = &b->m[c * 4];
+        __m128 acc = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        acc = _mm_add_ps(acc, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        col[c] = acc;
+    }
+    for (int c = 0; c < 4; c++) {
+        _mm_storeu_ps(&out->m[c * 4], col[c]);
+    }
+#else
+    mat4_t result;
     for (int col = 0; col < 4; col++) {
         for (int row = 0; row < 4; row++) {
             float sum = 0.0f;
             for (int i = 0; i < 4; i++) {
-                sum += a.m[i * 4 + row] * b.m[col * 4 + i];
+                sum += a->m[i * 4 + row] * b->m[col * 4 + i];
             }
             result.m[col * 4 + row] = sum;
         }
     }
+    *out = result;
+#endif
+}
+
+mat4_t mat4_multiply(mat4_t a, mat4_t b) {
+    mat4_t result;
+    mat4_multiply_into(&result, &a, &b);
     return result;
 }
 
-mat4_t mat4_rotate_xyz(float rx, float ry, float rz) {
-    mat4_t rxm = mat4_rotate_x(rx);
-    mat4_t rym = mat4_rotate_y(ry);
-    mat4_t rzm = mat4_rotate_z(rz);
-    mat4_t r = mat4_multiply(rym, rxm); // Y * X
-    r = mat4_multiply(rzm, r);          // Z * (Y * X)
+vec4_t mat4_mul_vec4(const mat4_t* m, vec4_t v) {
+    vec4_t r;
+#ifdef MATH3D_SSE
+    __m128 acc = _mm_mul_ps(_mm_loadu_ps(&m->m[0]), _mm_set1_ps(v.x));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&m->m[4]), _mm_set1_ps(v.y)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&m->m[8]), _mm_set1_ps(v.z)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(&m->m[12]), _mm_set1_ps(v.w)));
+    _mm_storeu_ps(&r.x, acc);
+#else
+    r.x = m->m[0] * v.x + m->m[4] * v.y + m->m[8]  * v.z + m->m[12] * v.w;
+    r.y = m->m[1] * v.x + m->m[5] * v.y + m->m[9]  * v.z + m->m[13] * v.w;
+    r.z = m->m[2] * v.x + m->m[6] * v.y + m->m[10] * v.z + m->m[14] * v.w;
+    r.w = m->m[3] * v.x + m->m[7] * v.y + m->m[11] * v.z + m->m[15] * v.w;
+#endif
     return r;
 }
 
+void mat4_transform_points(const mat4_t* m, const vec3f_t* in, vec4_t* out, int count) {
+    int i = 0;
+#ifdef MATH3D_AVX
+    // Two points per iteration: each 128-bit lane holds one transformed point
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)&m->m[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128*)&m->m[4]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)&m->m[8]);
+    __m256 c3 = _mm256_broadcast_ps((const __m128*)&m->m[12]);
+    for (; i + 2 <= count; i += 2) {
+        __m256 x = _mm256_set_m128(_mm_set1_ps(in[i + 1].x), _mm_set1_ps(in[i].x));
+        __m256 y = _mm256_set_m128(_mm_set1_ps(in[i + 1].y), _mm_set1_ps(in[i].y));
+        __m256 z = _mm256_set_m128(_mm_set1_ps(in[i + 1].z), _mm_set1_ps(in[i].z));
+        __m256 acc = _mm256_mul_ps(c0, x);
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(c1, y));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(c2, z));
+        acc = _mm256_add_ps(acc, c3);
+        _mm256_storeu_ps(&out[i].x, acc);
+    }
+#endif
+#ifdef MATH3D_SSE
+    __m128 m0 = _mm_loadu_ps(&m->m[0]);
+    __m128 m1 = _mm_loadu_ps(&m->m[4]);
+    __m128 m2 = _mm_loadu_ps(&m->m[8]);
+    __m128 m3 = _mm_loadu_ps(&m->m[12]);
+    for (; i < count; i++) {
+        __m128 acc = _mm_mul_ps(m0, _mm_set1_ps(in[i].x));
+        acc = _mm_add_ps(acc, _mm_mul_ps(m1, _mm_set1_ps(in[i].y)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(m2, _mm_set1_ps(in[i].z)));
+        acc = _mm_add_ps(acc, m3);
+        _mm_storeu_ps(&out[i].x, acc);
+    }
+#else
+    for (; i < count; i++) {
+        float x = in[i].x, y = in[i].y, z = in[i].z;
+        out[i].x = m->m[0] * x + m->m[4] * y + m->m[8]  * z + m->m[12];
+        out[i].y = m->m[1] * x + m->m[5] * y + m->m[9]  * z + m->m[13];
+        out[i].z = m->m[2] * x + m->m[6] * y + m->m[10] * z + m->m[14];
+        out[i].w = m->m[3] * x + m->m[7] * y + m->m[11] * z + m->m[15];
+    }
+#endif
+}
+
+// Closed form of Rz(rz) * Ry(ry) * Rx(rx): one sin/cos pair per axis and
+// no intermediate matrices
+mat4_t mat4_rotate_xyz(float rx, float ry, float rz) {
+    float cx = cosf(rx), sx = sinf(rx);
+    float cy = cosf(ry), sy = sinf(ry);
+    float cz = cosf(rz), sz = sinf(rz);
+
+    mat4_t m = { 0 };
+    m.m[0]  = cz * cy;
+    m.m[1]  = sz * cy;
+    m.m[2]  = -sy;
+    m.m[4]  = cz * sy * sx - sz * cx;
+    m.m[5]  = sz * sy * sx + cz * cx;
+    m.m[6]  = cy * sx;
+    m.m[8]  = cz * sy * cx + sz * sx;
+    m.m[9]  = sz * sy * cx - cz * sx;
+    m.m[10] = cy * cx;
+    m.m[15] = 1.0f;
+    return m;
+}
+
 mat4_t mat4_frustum(float left, float right, float bottom, float top, float near, float far) {
     mat4_t m = { 0 };
 
@@ -188,4 +258,303 @@ mat4_t mat4_frustum(float left, float right, float bottom, float top, float near
     return m;
 }
 
+// --- quat functions ---
+
+quat_t quat_from_axis_angle(vec3f_t axis, float angle) {
+    vec3f_t n = vec3f_normalize(axis);
+    float s = sinf(angle * 0.5f);
+    quat_t q = { n.x * s, n.y * s, n.z * s, cosf(angle * 0.5f) };
+    return q;
+}
+
+quat_t quat_from_euler_xyz(float rx, float ry, float rz) {
+    float cx = cosf(rx * 0.5f), sx = sinf(rx * 0.5f);
+    float cy = cosf(ry * 0.5f), sy = sinf(ry * 0.5f);
+    float cz = cosf(rz * 0.5f), sz = sinf(rz * 0.5f);
+
+    // qz * qy * qx, expanded
+    quat_t q = {
+        cz * cy * sx - sz * sy * cx,
+        cz * sy * cx + sz * cy * sx,
+        sz * cy * cx - cz * sy * sx,
+        cz * cy * cx + sz * sy * sx
+    };
+    return q;
+}
+
+quat_t quat_from_mat4(const mat4_t* m) {
+    // R[row][col] = m[col * 4 + row]; pick the largest diagonal term for stability
+    float r00 = m->m[0], r11 = m->m[5], r22 = m->m[10];
+    float trace = r00 + r11 + r22;
+    quat_t q;
+
+    if (trace > 0.0f) {
+        float s = sqrtf(trace + 1.0f) * 2.0f;
+        q.w = 0.25f * s;
+        q.x = (m->m[6] - m->m[9]) / s;
+        q.y = (m->m[8] - m->m[2]) / s;
+        q.z = (m->m[1] - m->m[4]) / s;
+    } else if (r00 > r11 && r00 > r22) {
+        float s = sqrtf(1.0f + r00 - r11 - r22) * 2.0f;
+        q.w = (m->m[6] - m->m[9]) / s;
+        q.x = 0.25f * s;
+        q.y = (m->m[4] + m->m[1]) / s;
+        q.z = (m->m[8] + m->m[2]) / s;
+    } else if (r11 > r22) {
+        float s = sqrtf(1.0f + r11 - r00 - r22) * 2.0f;
+        q.w = (m->m[8] - m->m[2]) / s;
+        q.x = (m->m[4] + m->m[1]) / s;
+        q.y = 0.25f * s;
+        q.z = (m->m[9] + m->m[6]) / s;
+    } else {
+        float s = sqrtf(1.0f + r22 - r00 - r11) * 2.0f;
+        q.w = (m->m[1] - m->m[4]) / s;
+        q.x = (m->m[8] + m->m[2]) / s;
+        q.y = (m->m[9] + m->m[6]) / s;
+        q.z = 0.25f * s;
+    }
+    return quat_normalize(q);
+}
+
+quat_t quat_look_rotation(vec3f_t forward) {
+    forward = vec3f_normalize(forward);
+
+    // Avoid degenerate 'up' when forward is close to Y
+    vec3f_t world_up = vec3f_make(0.0f, 1.0f, 0.0f);
+    if (fabsf(forward.x) < 1e-3f && fabsf(forward.z) < 1e-3f)
+        world_up = vec3f_make(0.0f, 0.0f, 1.0f);
+
+    // right = forward x up keeps the basis right-handed (det +1)
+    vec3f_t right = vec3f_normalize(vec3f_cross(forward, world_up));
+    vec3f_t up = vec3f_cross(right, forward);
+
+    mat4_t m = mat4_identity();
+    m.m[0] = right.x; m.m[4] = right.y; m.m[8]  = right.z;
+    m.m[1] = up.x;    m.m[5] = up.y;    m.m[9]  = up.z;
+    m.m[2] = -forward.x; m.m[6] = -forward.y; m.m[10] = -forward.z;
+    return quat_from_mat4(&m);
+}
+
+quat_t quat_nlerp(quat_t a, quat_t b, float t) {
+    float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+    float u = 1.0f - t;
+    float v = t * sign;
+    quat_t q = { a.x * u + b.x * v, a.y * u + b.y * v, a.z * u + b.z * v, a.w * u + b.w * v };
+    return quat_normalize(q);
+}
+
+quat_t quat_slerp(quat_t a, quat_t b, float t) {
+    float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    if (dot < 0.0f) {
+        b.x = -b.x; b.y = -b.y; b.z = -b.z; b.w = -b.w;
+        dot = -dot;
+    }
+
+    // Nearly parallel: nlerp is indistinguishable and avoids dividing by sin(0)
+    if (dot > 0.9995f) return quat_nlerp(a, b, t);
+
+    float theta = acosf(dot);
+    float inv_sin = 1.0f / sinf(theta);
+    float wa = sinf((1.0f - t) * theta) * inv_sin;
+    float wb = sinf(t * theta) * inv_sin;
+    quat_t q = {
+        a.x * wa + b.x * wb,
+        a.y * wa + b.y * wb,
+        a.z * wa + b.z * wb,
+        a.w * wa + b.w * wb
+    };
+    return q;
+}
+
+mat4_t quat_to_mat4(quat_t q) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    mat4_t m = { 0 };
+    m.m[0]  = 1.0f - 2.0f * (yy + zz);
+    m.m[1]  = 2.0f * (xy + wz);
+    m.m[2]  = 2.0f * (xz - wy);
+    m.m[4]  = 2.0f * (xy - wz);
+    m.m[5]  = 1.0f - 2.0f * (xx + zz);
+    m.m[6]  = 2.0f * (yz + wx);
+    m.m[8]  = 2.0f * (xz + wy);
+    m.m[9]  = 2.0f * (yz - wx);
+    m.m[10] = 1.0f - 2.0f * (xx + yy);
+    m.m[15] = 1.0f;
+    return m;
+}
+
+// --- affine functions ---
+
+affine_t affine_rotate_xyz(float rx, float ry, float rz) {
+    float cx = cosf(rx), sx = sinf(rx);
+    float cy = cosf(ry), sy = sinf(ry);
+    float cz = cosf(rz), sz = sinf(rz);
+
+    affine_t a = { { 0 } };
+    a.m[0]  = cz * cy;
+    a.m[1]  = cz * sy * sx - sz * cx;
+    a.m[2]  = cz * sy * cx + sz * sx;
+    a.m[4]  = sz * cy;
+    a.m[5]  = sz * sy * sx + cz * cx;
+    a.m[6]  = sz * sy * cx - cz * sx;
+    a.m[8]  = -sy;
+    a.m[9]  = cy * sx;
+    a.m[10] = cy * cx;
+    return a;
+}
 
+affine_t affine_from_quat(quat_t q, vec3f_t translation) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    affine_t a = { {
+        1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz),        2.0f * (xz + wy),        translation.x,
+        2.0f * (xy + wz),        1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx),        translation.y,
+        2.0f * (xz - wy),        2.0f * (yz + wx),        1.0f - 2.0f * (xx + yy), translation.z
+    } };
+    return a;
+}
+
+void affine_multiply_into(affine_t* out, const affine_t* a, const affine_t* b) {
+#ifdef MATH3D_SSE
+    // Row i of the result combines the rows of b, plus a's translation in the w lane
+    __m128 b0 = _mm_loadu_ps(&b->m[0]);
+    __m128 b1 = _mm_loadu_ps(&b->m[4]);
+    __m128 b2 = _mm_loadu_ps(&b->m[8]);
+    __m128 row[3];
+    for (int r = 0; r < 3; r++) {
+        const float* ar = &a->m[r * 4];
+        __m128 acc = _mm_mul_ps(b0, _mm_set1_ps(ar[0]));
+        acc = _mm_add_ps(acc, _mm_mul_ps(b1, _mm_set1_ps(ar[1])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(b2, _mm_set1_ps(ar[2])));
+        row[r] = _mm_add_ps(acc, _mm_set_ps(ar[3], 0.0f, 0.0f, 0.0f));
+    }
+    for (int r = 0; r < 3; r++) {
+        _mm_storeu_ps(&out->m[r * 4], row[r]);
+    }
+#else
+    affine_t result;
+    for (int row = 0; row < 3; row++) {
+        const float* ar = &a->m[row * 4];
+        for (int col = 0; col < 4; col++) {
+            result.m[row * 4 + col] = ar[0] * b->m[col] + ar[1] * b->m[4 + col] + ar[2] * b->m[8 + col];
+        }
+        result.m[row * 4 + 3] += ar[3];
+    }
+    *out = result;
+#endif
+}
+
+affine_t affine_multiply(affine_t a, affine_t b) {
+    affine_t result;
+    affine_multiply_into(&result, &a, &b);
+    return result;
+}
+
+int affine_inverse(affine_t* out, const affine_t* a) {
+    const float* m = a->m;
+
+    // Cofactors of the 3x3 linear part (first column of the adjugate)
+    float c00 = m[5] * m[10] - m[6] * m[9];
+    float c10 = m[6] * m[8]  - m[4] * m[10];
+    float c20 = m[4] * m[9]  - m[5] * m[8];
+    float det = m[0] * c00 + m[1] * c10 + m[2] * c20;
+    if (fabsf(det) < 1e-12f) return -1;
+
+    float inv_det = 1.0f / det;
+    affine_t r;
+    r.m[0]  = c00 * inv_det;
+    r.m[1]  = (m[2] * m[9]  - m[1] * m[10]) * inv_det;
+    r.m[2]  = (m[1] * m[6]  - m[2] * m[5])  * inv_det;
+    r.m[4]  = c10 * inv_det;
+    r.m[5]  = (m[0] * m[10] - m[2] * m[8])  * inv_det;
+    r.m[6]  = (m[2] * m[4]  - m[0] * m[6])  * inv_det;
+    r.m[8]  = c20 * inv_det;
+    r.m[9]  = (m[1] * m[8]  - m[0] * m[9])  * inv_det;
+    r.m[10] = (m[0] * m[5]  - m[1] * m[4])  * inv_det;
+
+    // t' = -R^-1 * t
+    float t0 = m[3], t1 = m[7], t2 = m[11];
+    r.m[3]  = -(r.m[0] * t0 + r.m[1] * t1 + r.m[2]  * t2);
+    r.m[7]  = -(r.m[4] * t0 + r.m[5] * t1 + r.m[6]  * t2);
+    r.m[11] = -(r.m[8] * t0 + r.m[9] * t1 + r.m[10] * t2);
+
+    *out = r;
+    return 0;
+}
+
+affine_t affine_inverse_rigid(affine_t a) {
+    // R^-1 = R^T, t' = -R^T * t
+    affine_t r;
+    r.m[0] = a.m[0]; r.m[1] = a.m[4]; r.m[2]  = a.m[8];
+    r.m[4] = a.m[1]; r.m[5] = a.m[5]; r.m[6]  = a.m[9];
+    r.m[8] = a.m[2]; r.m[9] = a.m[6]; r.m[10] = a.m[10];
+
+    float t0 = a.m[3], t1 = a.m[7], t2 = a.m[11];
+    r.m[3]  = -(r.m[0] * t0 + r.m[1] * t1 + r.m[2]  * t2);
+    r.m[7]  = -(r.m[4] * t0 + r.m[5] * t1 + r.m[6]  * t2);
+    r.m[11] = -(r.m[8] * t0 + r.m[9] * t1 + r.m[10] * t2);
+    return r;
+}
+
+void affine_transform_points(const affine_t* a, const vec3f_t* in, vec3f_t* out, int count) {
+    // Hoist the matrix into locals so the loop doesn't reload through 'a' (out may alias it)
+    float m0 = a->m[0], m1 = a->m[1], m2  = a->m[2],  tx = a->m[3];
+    float m4 = a->m[4], m5 = a->m[5], m6  = a->m[6],  ty = a->m[7];
+    float m8 = a->m[8], m9 = a->m[9], m10 = a->m[10], tz = a->m[11];
+
+    for (int i = 0; i < count; i++) {
+        float x = in[i].x, y = in[i].y, z = in[i].z;
+        out[i].x = m0 * x + m1 * y + m2  * z + tx;
+        out[i].y = m4 * x + m5 * y + m6  * z + ty;
+        out[i].z = m8 * x + m9 * y + m10 * z + tz;
+    }
+}
+
+mat4_t affine_to_mat4(affine_t a) {
+    mat4_t m;
+    for (int col = 0; col < 4; col++) {
+        m.m[col * 4 + 0] = a.m[col];
+        m.m[col * 4 + 1] = a.m[4 + col];
+        m.m[col * 4 + 2] = a.m[8 + col];
+        m.m[col * 4 + 3] = (col == 3) ? 1.0f : 0.0f;
+    }
+    return m;
+}
+
+void mat4_multiply_affine(mat4_t* out, const mat4_t* p, const affine_t* a) {
+#ifdef MATH3D_SSE
+    // Column j of the result combines the first three columns of p (plus the
+    // fourth for the translation column, whose implicit w is 1)
+    __m128 p0 = _mm_loadu_ps(&p->m[0]);
+    __m128 p1 = _mm_loadu_ps(&p->m[4]);
+    __m128 p2 = _mm_loadu_ps(&p->m[8]);
+    __m128 p3 = _mm_loadu_ps(&p->m[12]);
+    __m128 col[4];
+    for (int c = 0; c < 4; c++) {
+        __m128 acc = _mm_mul_ps(p0, _mm_set1_ps(a->m[c]));
+        acc = _mm_add_ps(acc, _mm_mul_ps(p1, _mm_set1_ps(a->m[4 + c])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(p2, _mm_set1_ps(a->m[8 + c])));
+        col[c] = acc;
+    }
+    col[3] = _mm_add_ps(col[3], p3);
+    for (int c = 0; c < 4; c++) {
+        _mm_storeu_ps(&out->m[c * 4], col[c]);
+    }
+#else
+    mat4_t result;
+    for (int col = 0; col < 4; col++) {
+        float b0 = a->m[col], b1 = a->m[4 + col], b2 = a->m[8 + col];
+        for (int row = 0; row < 4; row++) {
+            float sum = p->m[row] * b0 + p->m[4 + row] * b1 + p->m[8 + row] * b2;
+            if (col == 3) sum += p->m[12 + row];
+            result.m[col * 4 + row] = sum;
+        }
+    }
+    *out = result;
+#endif
+}
@@ -0,0 +1,286 @@
+// mesh.c
+#define _POSIX_C_SOURCE 200112L
+
+#include "mesh.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(MESH_NO_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MESH_MMAP
+#endif
+
+mesh_t* mesh_create(int vert_count, int edge_count) {
+    mesh_t* mesh = calloc(1, sizeof(mesh_t));
+    if (!mesh) return NULL;
+
+    mesh->vert_count = vert_count;
+    mesh->edge_count = edge_count;
+    mesh->px = calloc(vert_count > 0 ? vert_count : 1, sizeof(float));
+    mesh->py = calloc(vert_count > 0 ? vert_count : 1, sizeof(float));
+    mesh->pz = calloc(vert_count > 0 ? vert_count : 1, sizeof(float));
+    mesh->edges = calloc(edge_count > 0 ? edge_count : 1, sizeof(*mesh->edges));
+
+    int edge_slots = edge_count > 0 ? edge_count : 1;
+    mesh->mid_x = calloc(edge_slots, sizeof(float));
+    mesh->mid_y = calloc(edge_slots, sizeof(float));
+    mesh->mid_z = calloc(edge_slots, sizeof(float));
+    mesh->normal_x = calloc(edge_slots, sizeof(float));
+    mesh->normal_y = calloc(edge_slots, sizeof(float));
+    mesh->normal_z = calloc(edge_slots, sizeof(float));
+    if (!mesh->px || !mesh->py || !mesh->pz || !mesh->edges ||
+        !mesh->mid_x || !mesh->mid_y || !mesh->mid_z ||
+        !mesh->normal_x || !mesh->normal_y || !mesh->normal_z) {
+        mesh_destroy(mesh);
+        return NULL;
+    }
+    return mesh;
+}
+
+mesh_t* mesh_from_vec3(const vec3_t* verts, int vert_count, int edges[][2], int edge_count) {
+    mesh_t* mesh = mesh_create(vert_count, edge_count);
+    if (!mesh) return NULL;
+
+    for (int i = 0; i < vert_count; i++) {
+        mesh->px[i] = verts[i].x;
+        mesh->py[i] = verts[i].y;
+        mesh->pz[i] = verts[i].z;
+    }
+    memcpy(mesh->edges, edges, edge_count * sizeof(*mesh->edges));
+    mesh_update_edge_cache(mesh);
+    return mesh;
+}
+
+void mesh_destroy(mesh_t* mesh) {
+    if (!mesh) return;
+
+    if (mesh->storage) {
+#ifdef MESH_MMAP
+        if (mesh->storage_mapped) munmap(mesh->storage, mesh->storage_size);
+        else free(mesh->storage);
+#else
+        free(mesh->storage);
+#endif
+        free(mesh);
+        return;
+    }
+
+    free(mesh->px);
+    free(mesh->py);
+    free(mesh->pz);
+    free(mesh->edges);
+    free(mesh->mid_x);
+    free(mesh->mid_y);
+    free(mesh->mid_z);
+    free(mesh->normal_x);
+    free(mesh->normal_y);
+    free(mesh->normal_z);
+    free(mesh);
+}
+
+void mesh_set_positions(mesh_t* mesh, const vec3f_t* points) {
+    for (int i = 0; i < mesh->vert_count; i++) {
+        mesh->px[i] = points[i].x;
+        mesh->py[i] = points[i].y;
+        mesh->pz[i] = points[i].z;
+    }
+    mesh_update_edge_cache(mesh);
+}
+
+void mesh_update_edge_cache(mesh_t* mesh) {
+    // Bounding sphere centred on the box centre (not minimal, but cheap and stable)
+    vec3f_t lo = vec3f_make(0.0f, 0.0f, 0.0f), hi = lo;
+    for (int i = 0; i < mesh->vert_count; i++) {
+        if (i == 0 || mesh->px[i] < lo.x) lo.x = mesh->px[i];
+        if (i == 0 || mesh->py[i] < lo.y) lo.y = mesh->py[i];
+        if (i == 0 || mesh->pz[i] < lo.z) lo.z = mesh->pz[i];
+        if (i == 0 || mesh->px[i] > hi.x) hi.x = mesh->px[i];
+        if (i == 0 || mesh->py[i] > hi.y) hi.y = mesh->py[i];
+        if (i == 0 || mesh->pz[i] > hi.z) hi.z = mesh->pz[i];
+    }
+    mesh->bound_center = vec3f_scale(vec3f_add(lo, hi), 0.5f);
+    mesh->bound_radius = 0.0f;
+    for (int i = 0; i < mesh->vert_count; i++) {
+        float d = vec3f_length(vec3f_sub(vec3f_make(mesh->px[i], mesh->py[i], mesh->pz[i]), mesh->bound_center));
+        if (d > mesh->bound_radius) mesh->bound_radius = d;
+    }
+
+    for (int e = 0; e < mesh->edge_count; e++) {
+        int i0 = mesh->edges[e][0];
+        int i1 = mesh->edges[e][1];
+        vec3f_t mid = vec3f_make(0.5f * (mesh->px[i0] + mesh->px[i1]),
+                                 0.5f * (mesh->py[i0] + mesh->py[i1]),
+                                 0.5f * (mesh->pz[i0] + mesh->pz[i1]));
+        vec3f_t normal = vec3f_normalize(mid);
+        mesh->mid_x[e] = mid.x;
+        mesh->mid_y[e] = mid.y;
+        mesh->mid_z[e] = mid.z;
+        mesh->normal_x[e] = normal.x;
+        mesh->normal_y[e] = normal.y;
+        mesh->normal_z[e] = normal.z;
+    }
+}
+
+// --- Binary mesh files ---
+
+#define MESH_FILE_ALIGN 64
+#define MESH_BYTE_ORDER 0x01020304u
+
+enum {
+    MESH_SECTION_PX, MESH_SECTION_PY, MESH_SECTION_PZ, MESH_SECTION_EDGES,
+    MESH_SECTION_MID_X, MESH_SECTION_MID_Y, MESH_SECTION_MID_Z,
+    MESH_SECTION_NORMAL_X, MESH_SECTION_NORMAL_Y, MESH_SECTION_NORMAL_Z,
+    MESH_SECTION_COUNT
+};
+
+typedef struct {
+    char magic[8];                      // "T3DMESH"
+    uint32_t byte_order;                // MESH_BYTE_ORDER as stored by the writer
+    uint32_t version;
+    uint32_t vert_count;
+    uint32_t edge_count;
+    float bound_center[3];
+    float bound_radius;
+    uint64_t offset[MESH_SECTION_COUNT];
+    uint64_t file_size;
+} mesh_file_header_t;
+
+static const char mesh_magic[8] = "T3DMESH";
+
+static uint64_t section_bytes(int section, uint64_t vert_count, uint64_t edge_count) {
+    if (section <= MESH_SECTION_PZ) return vert_count * sizeof(float);
+    if (section == MESH_SECTION_EDGES) return edge_count * 2 * sizeof(int32_t);
+    return edge_count * sizeof(float);
+}
+
+// Section offsets after the header, each rounded up to MESH_FILE_ALIGN
+static void mesh_file_layout(mesh_file_header_t* header) {
+    uint64_t at = sizeof(mesh_file_header_t);
+    for (int s = 0; s < MESH_SECTION_COUNT; s++) {
+        at = (at + MESH_FILE_ALIGN - 1) / MESH_FILE_ALIGN * MESH_FILE_ALIGN;
+        header->offset[s] = at;
+        at += section_bytes(s, header->vert_count, header->edge_count);
+    }
+    header->file_size = at;
+}
+
+int mesh_save(const mesh_t* mesh, const char* filename) {
+    if (!mesh || !filename || mesh->vert_count < 0 || mesh->edge_count < 0) return -1;
+
+    mesh_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, mesh_magic, sizeof(header.magic));
+    header.byte_order = MESH_BYTE_ORDER;
+    header.version = MESH_FILE_VERSION;
+    header.vert_count = (uint32_t)mesh->vert_count;
+    header.edge_count = (uint32_t)mesh->edge_count;
+    header.bound_center[0] = mesh->bound_center.x;
+    header.bound_center[1] = mesh->bound_center.y;
+    header.bound_center[2] = mesh->bound_center.z;
+    header.bound_radius = mesh->bound_radius;
+    mesh_file_layout(&header);
+
+    const void* data[MESH_SECTION_COUNT] = {
+        mesh->px, mesh->py, mesh->pz, mesh->edges,
+        mesh->mid_x, mesh->mid_y, mesh->mid_z, mesh->normal_x, mesh->normal_y, mesh->normal_z
+    };
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) return -1;
+    static const char zeros[MESH_FILE_ALIGN] = { 0 };
+    int failed = fwrite(&header, sizeof(header), 1, file) != 1;
+    uint64_t at = sizeof(header);
+    for (int s = 0; s < MESH_SECTION_COUNT && !failed; s++) {
+        size_t bytes = (size_t)section_bytes(s, header.vert_count, header.edge_count);
+        failed |= fwrite(zeros, 1, (size_t)(header.offset[s] - at), file) != header.offset[s] - at;
+        failed |= bytes > 0 && fwrite(data[s], 1, bytes, file) != bytes;
+        at = header.offset[s] + bytes;
+    }
+    failed |= fclose(file) != 0;
+    return failed ? -1 : 0;
+}
+
+// Header checks: the layout must be the one mesh_save writes for these counts
+static int mesh_file_valid(const mesh_file_header_t* header, uint64_t size) {
+    if (memcmp(header->magic, mesh_magic, sizeof(mesh_magic)) != 0) return 0;
+    if (header->byte_order != MESH_BYTE_ORDER || header->version != MESH_FILE_VERSION) return 0;
+    if (header->vert_count > INT32_MAX || header->edge_count > INT32_MAX) return 0;
+
+    mesh_file_header_t expected = *header;
+    mesh_file_layout(&expected);
+    return memcmp(expected.offset, header->offset, sizeof(expected.offset)) == 0 &&
+           expected.file_size == header->file_size && header->file_size <= size;
+}
+
+mesh_t* mesh_load(const char* filename) {
+    if (!filename) return NULL;
+
+    void* base = NULL;
+    size_t size = 0;
+    int mapped = 0;
+
+#ifdef MESH_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(mesh_file_header_t)) {
+        size = (size_t)st.st_size;
+        // Private and writable: mesh_set_positions on a loaded mesh copies pages on write
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) base = NULL;
+        mapped = base != NULL;
+    }
+    close(fd);
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) return NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (end >= (long)sizeof(mesh_file_header_t) && fseek(file, 0, SEEK_SET) == 0) {
+            size = (size_t)end;
+            base = malloc(size);
+            if (base && fread(base, 1, size, file) != size) {
+                free(base);
+                base = NULL;
+            }
+        }
+    }
+    fclose(file);
+#endif
+    if (!base) return NULL;
+
+    const mesh_file_header_t* header = (const mesh_file_header_t*)base;
+    mesh_t* mesh = mesh_file_valid(header, size) ? calloc(1, sizeof(mesh_t)) : NULL;
+    if (!mesh) {
+#ifdef MESH_MMAP
+        munmap(base, size);
+#else
+        free(base);
+#endif
+        return NULL;
+    }
+
+    char* bytes = (char*)base;
+    mesh->vert_count = (int)header->vert_count;
+    mesh->edge_count = (int)header->edge_count;
+    mesh->px = (float*)(bytes + header->offset[MESH_SECTION_PX]);
+    mesh->py = (float*)(bytes + header->offset[MESH_SECTION_PY]);
+    mesh->pz = (float*)(bytes + header->offset[MESH_SECTION_PZ]);
+    mesh->edges = (int (*)[2])(bytes + header->offset[MESH_SECTION_EDGES]);
+    mesh->mid_x = (float*)(bytes + header->offset[MESH_SECTION_MID_X]);
+    mesh->mid_y = (float*)(bytes + header->offset[MESH_SECTION_MID_Y]);
+    mesh->mid_z = (float*)(bytes + header->offset[MESH_SECTION_MID_Z]);
+    mesh->normal_x = (float*)(bytes + header->offset[MESH_SECTION_NORMAL_X]);
+    mesh->normal_y = (float*)(bytes + header->offset[MESH_SECTION_NORMAL_Y]);
+    mesh->normal_z = (float*)(bytes + header->offset[MESH_SECTION_NORMAL_Z]);
+    mesh->bound_center = vec3f_make(header->bound_center[0], header->bound_center[1], header->bound_center[2]);
+    mesh->bound_radius = header->bound_radius;
+    mesh->storage = base;
+    mesh->storage_size = size;
+    mesh->storage_mapped = mapped;
+    return mesh;
+}
@@ -0,0 +1,607 @@
+// mesh_import.c
+#if !defined(_WIN32) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L  // st_mtim
+#endif
+
+#include "mesh_import.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define IMPORT_CHUNK (64 * 1024)     // bytes read per fread
+#define IMPORT_LINE_MAX (64 * 1024)  // longest accepted text line
+
+// --- Chunked input ---
+
+typedef struct {
+    FILE* file;
+    char* buf;              // IMPORT_CHUNK + IMPORT_LINE_MAX bytes plus a terminator
+    size_t len;             // valid bytes in buf
+    size_t pos;             // next unread byte
+    int eof;
+    long line;              // current line number for messages
+} import_stream_t;
+
+static int stream_open(import_stream_t* in, const char* filename) {
+    memset(in, 0, sizeof(*in));
+    in->file = fopen(filename, "rb");
+    if (!in->file) return -1;
+    in->buf = malloc(IMPORT_CHUNK + IMPORT_LINE_MAX + 1);
+    if (!in->buf) {
+        fclose(in->file);
+        return -1;
+    }
+    return 0;
+}
+
+static void stream_close(import_stream_t* in) {
+    if (in->file) fclose(in->file);
+    free(in->buf);
+}
+
+// Move the unread tail to the front and append one more chunk
+static void stream_fill(import_stream_t* in) {
+    if (in->eof) return;
+    memmove(in->buf, in->buf + in->pos, in->len - in->pos);
+    in->len -= in->pos;
+    in->pos = 0;
+    size_t room = IMPORT_CHUNK + IMPORT_LINE_MAX - in->len;
+    size_t got = fread(in->buf + in->len, 1, room < IMPORT_CHUNK ? room : IMPORT_CHUNK, in->file);
+    if (got == 0) in->eof = 1;
+    in->len += got;
+}
+
+// Next line without its newline, NUL-terminated in place; NULL at the end or
+// for lines longer than IMPORT_LINE_MAX
+static char* stream_line(import_stream_t* in) {
+    for (;;) {
+        char* start = in->buf + in->pos;
+        char* nl = memchr(start, '\n', in->len - in->pos);
+        if (nl || (in->eof && in->pos < in->len)) {
+            char* end = nl ? nl : in->buf + in->len;
+            in->pos = nl ? (size_t)(nl - in->buf) + 1 : in->len;
+            if (end > start && end[-1] == '\r') end--;
+            *end = '\0';
+            in->line++;
+            return start;
+        }
+        if (in->eof) return NULL;
+        if (in->len - in->pos >= IMPORT_LINE_MAX) return NULL;
+        stream_fill(in);
+    }
+}
+
+// Pointer to the next count raw bytes; NULL if the file ends first
+static const unsigned char* stream_bytes(import_stream_t* in, size_t count) {
+    while (in->len - in->pos < count) {
+        if (in->eof) return NULL;
+        stream_fill(in);
+    }
+    const unsigned char* p = (const unsigned char*)in->buf + in->pos;
+    in->pos += count;
+    return p;
+}
+
+// --- Growing output arrays and the edge set ---
+
+typedef struct {
+    float* px;
+    float* py;
+    float* pz;
+    int vert_count, vert_capacity;
+    int (*edges)[2];
+    int edge_count, edge_capacity;
+    uint64_t* edge_set;     // open addressing; 0 is empty (self-loops are never stored)
+    size_t set_mask;
+} import_builder_t;
+
+// Doubled from current (or 1024) until it holds count, capped at INT_MAX
+// elements; 0 if count is out of range or the bytes would not fit a size_t
+static size_t grow_capacity(int current, long count, size_t element_size) {
+    if (count < 0 || count > INT_MAX) return 0;
+    size_t capacity = current ? (size_t)current : 1024;
+    while (capacity < (size_t)count) capacity = capacity > INT_MAX / 2 ? INT_MAX : capacity * 2;
+    return capacity <= SIZE_MAX / element_size ? capacity : 0;
+}
+
+static int builder_reserve_verts(import_builder_t* b, long count) {
+    if (count <= b->vert_capacity) return 0;
+    size_t capacity = grow_capacity(b->vert_capacity, count, sizeof(float));
+    if (!capacity) return -1;
+    float* px = realloc(b->px, capacity * sizeof(float));
+    if (px) b->px = px;
+    float* py = realloc(b->py, capacity * sizeof(float));
+    if (py) b->py = py;
+    float* pz = realloc(b->pz, capacity * sizeof(float));
+    if (pz) b->pz = pz;
+    if (!px || !py || !pz) return -1;
+    b->vert_capacity = (int)capacity;
+    return 0;
+}
+
+static int builder_add_vert(import_builder_t* b, float x, float y, float z) {
+    if (builder_reserve_verts(b, (long)b->vert_count + 1) != 0) return -1;
+    b->px[b->vert_count] = x;
+    b->py[b->vert_count] = y;
+    b->pz[b->vert_count] = z;
+    b->vert_count++;
+    return 0;
+}
+
+static size_t edge_slot(uint64_t key, size_t mask) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+// Double the set and reinsert; keeps the load factor at or below 1/2
+static int builder_grow_set(import_builder_t* b) {
+    size_t capacity = b->edge_set ? (b->set_mask + 1) * 2 : 4096;
+    uint64_t* set = calloc(capacity, sizeof(uint64_t));
+    if (!set) return -1;
+    for (size_t i = 0; b->edge_set && i <= b->set_mask; i++) {
+        uint64_t key = b->edge_set[i];
+        if (!key) continue;
+        size_t slot = edge_slot(key, capacity - 1);
+        while (set[slot]) slot = (slot + 1) & (capacity - 1);
+        set[slot] = key;
+    }
+    free(b->edge_set);
+    b->edge_set = set;
+    b->set_mask = capacity - 1;
+    return 0;
+}
+
+// Add the undirected edge a-b unless it is a self-loop or already present
+static int builder_add_edge(import_builder_t* b, int a, int c) {
+    if (a == c) return 0;
+    uint64_t lo = (uint64_t)(a < c ? a : c), hi = (uint64_t)(a < c ? c : a);
+    uint64_t key = (lo << 32) | hi;
+
+    if (!b->edge_set || (size_t)b->edge_count * 2 >= b->set_mask + 1) {
+        if (builder_grow_set(b) != 0) return -1;
+    }
+    size_t slot = edge_slot(key, b->set_mask);
+    while (b->edge_set[slot]) {
+        if (b->edge_set[slot] == key) return 0;
+        slot = (slot + 1) & b->set_mask;
+    }
+
+    if (b->edge_count == b->edge_capacity) {
+        size_t capacity = grow_capacity(b->edge_capacity, (long)b->edge_count + 1, sizeof(*b->edges));
+        int (*edges)[2] = capacity ? realloc(b->edges, capacity * sizeof(*edges)) : NULL;
+        if (!edges) return -1;
+        b->edges = edges;
+        b->edge_capacity = (int)capacity;
+    }
+    b->edge_set[slot] = key;
+    b->edges[b->edge_count][0] = (int)lo;
+    b->edges[b->edge_count][1] = (int)hi;
+    b->edge_count++;
+    return 0;
+}
+
+static void builder_free(import_builder_t* b) {
+    free(b->px);
+    free(b->py);
+    free(b->pz);
+    free(b->edges);
+    free(b->edge_set);
+}
+
+// Shrink a grown array to count elements (at least one); keeps it if realloc fails
+static void* shrink_to_fit(void* data, int count, size_t size) {
+    void* smaller = realloc(data, (count > 0 ? count : 1) * size);
+    return smaller ? smaller : data;
+}
+
+// Hand the arrays to a mesh_t (no copy) and build its edge cache
+static mesh_t* builder_finish(import_builder_t* b) {
+    free(b->edge_set);
+    b->edge_set = NULL;
+    b->px = shrink_to_fit(b->px, b->vert_count, sizeof(float));
+    b->py = shrink_to_fit(b->py, b->vert_count, sizeof(float));
+    b->pz = shrink_to_fit(b->pz, b->vert_count, sizeof(float));
+    b->edges = shrink_to_fit(b->edges, b->edge_count, sizeof(*b->edges));
+
+    mesh_t* mesh = calloc(1, sizeof(mesh_t));
+    if (!mesh) return NULL;
+    int edge_slots = b->edge_count > 0 ? b->edge_count : 1;
+    mesh->vert_count = b->vert_count;
+    mesh->edge_count = b->edge_count;
+    mesh->px = b->px;
+    mesh->py = b->py;
+    mesh->pz = b->pz;
+    mesh->edges = b->edges;
+    b->px = b->py = b->pz = NULL;
+    b->edges = NULL;
+    mesh->mid_x = malloc(edge_slots * sizeof(float));
+    mesh->mid_y = malloc(edge_slots * sizeof(float));
+    mesh->mid_z = malloc(edge_slots * sizeof(float));
+    mesh->normal_x = malloc(edge_slots * sizeof(float));
+    mesh->normal_y = malloc(edge_slots * sizeof(float));
+    mesh->normal_z = malloc(edge_slots * sizeof(float));
+    if (!mesh->px || !mesh->py || !mesh->pz || !mesh->edges || !mesh->mid_x || !mesh->mid_y || !mesh->mid_z ||
+        !mesh->normal_x || !mesh->normal_y || !mesh->normal_z) {
+        mesh_destroy(mesh);
+        return NULL;
+    }
+    mesh_update_edge_cache(mesh);
+    return mesh;
+}
+
+// --- OBJ ---
+
+// Vertex index of an OBJ face/line token ("7", "7/2", "7//3", "-1"); -1 if invalid
+static int obj_index(const char* token, char** end, int vert_count) {
+    long index = strtol(token, end, 10);
+    if (*end == token) return -1;
+    while (**end && !isspace((unsigned char)**end)) (*end)++;   // skip /vt/vn
+    if (index < 0) index += vert_count + 1;
+    if (index < 1 || index > vert_count) return -1;
+    return (int)index - 1;
+}
+
+static int import_obj(import_stream_t* in, import_builder_t* b) {
+    char* line;
+    while ((line = stream_line(in)) != NULL) {
+        while (*line == ' ' || *line == '\t') line++;
+
+        if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t')) {
+            char* p = line + 2;
+            char* end;
+            float xyz[3];
+            for (int k = 0; k < 3; k++) {
+                xyz[k] = strtof(p, &end);
+                if (end == p) {
+                    printf("ERROR: line %ld: bad vertex\n", in->line);
+                    return -1;
+                }
+                p = end;
+            }
+            if (builder_add_vert(b, xyz[0], xyz[1], xyz[2]) != 0) return -1;
+        } else if ((line[0] == 'f' || line[0] == 'l') && (line[1] == ' ' || line[1] == '\t')) {
+            // Faces close their loop, polylines do not
+            int closed = line[0] == 'f';
+            char* p = line + 2;
+            int first = -1, prev = -1;
+            for (;;) {
+                while (*p == ' ' || *p == '\t') p++;
+                if (!*p) break;
+                char* end;
+                int index = obj_index(p, &end, b->vert_count);
+                if (index < 0) {
+                    printf("ERROR: line %ld: bad vertex index\n", in->line);
+                    return -1;
+                }
+                if (prev >= 0 && builder_add_edge(b, prev, index) != 0) return -1;
+                if (first < 0) first = index;
+                prev = index;
+                p = end;
+            }
+            if (closed && first >= 0 && builder_add_edge(b, prev, first) != 0) return -1;
+        }
+    }
+    if (!in->eof) {
+        printf("ERROR: line %ld: line too long\n", in->line + 1);
+        return -1;
+    }
+    return 0;
+}
+
+// --- PLY ---
+
+typedef enum { PLY_NONE, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64 } ply_type_t;
+typedef enum { PLY_ASCII, PLY_BINARY_LE, PLY_BINARY_BE } ply_format_t;
+
+#define PLY_MAX_PROPERTIES 32
+#define PLY_MAX_ELEMENTS 16
+
+typedef struct {
+    ply_type_t type;        // item type
+    ply_type_t count_type;  // PLY_NONE unless this is a list
+    int role;               // coordinate 0-2, or edge end 0-1; -1 otherwise
+} ply_property_t;
+
+typedef struct {
+    char name[32];
+    long count;
+    int kind;               // 0 other, 1 vertex, 2 face, 3 edge
+    int property_count;
+    ply_property_t properties[PLY_MAX_PROPERTIES];
+} ply_element_t;
+
+static ply_type_t ply_type(const char* name) {
+    static const struct { const char* name; ply_type_t type; } types[] = {
+        {"char", PLY_INT8}, {"int8", PLY_INT8}, {"uchar", PLY_UINT8}, {"uint8", PLY_UINT8},
+        {"short", PLY_INT16}, {"int16", PLY_INT16}, {"ushort", PLY_UINT16}, {"uint16", PLY_UINT16},
+        {"int", PLY_INT32}, {"int32", PLY_INT32}, {"uint", PLY_UINT32}, {"uint32", PLY_UINT32},
+        {"float", PLY_FLOAT32}, {"float32", PLY_FLOAT32}, {"double", PLY_FLOAT64}, {"float64", PLY_FLOAT64}
+    };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (strcmp(name, types[i].name) == 0) return types[i].type;
+    }
+    return PLY_NONE;
+}
+
+static size_t ply_size(ply_type_t type) {
+    static const size_t sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+    return sizes[type];
+}
+
+// One binary scalar as double, swapping bytes when the file's order differs
+static int ply_read_binary(import_stream_t* in, ply_type_t type, int swap, double* value) {
+    size_t size = ply_size(type);
+    const unsigned char* src = stream_bytes(in, size);
+    if (!src) return -1;
+    unsigned char raw[8];
+    for (size_t i = 0; i < size; i++) raw[i] = swap ? src[size - 1 - i] : src[i];
+
+    switch (type) {
+    case PLY_INT8:    { int8_t v;   memcpy(&v, raw, 1); *value = v; break; }
+    case PLY_UINT8:   { uint8_t v;  memcpy(&v, raw, 1); *value = v; break; }
+    case PLY_INT16:   { int16_t v;  memcpy(&v, raw, 2); *value = v; break; }
+    case PLY_UINT16:  { uint16_t v; memcpy(&v, raw, 2); *value = v; break; }
+    case PLY_INT32:   { int32_t v;  memcpy(&v, raw, 4); *value = v; break; }
+    case PLY_UINT32:  { uint32_t v; memcpy(&v, raw, 4); *value = v; break; }
+    case PLY_FLOAT32: { float v;    memcpy(&v, raw, 4); *value = v; break; }
+    case PLY_FLOAT64: { double v;   memcpy(&v, raw, 8); *value = v; break; }
+    default: return -1;
+    }
+    return 0;
+}
+
+// Reads the scalars of one element, from a text line or from binary data
+typedef struct {
+    import_stream_t* in;
+    ply_format_t format;
+    int swap;
+    char* cursor;           // ASCII: rest of the current line
+} ply_reader_t;
+
+static int ply_begin_element(ply_reader_t* r) {
+    if (r->format != PLY_ASCII) return 0;
+    r->cursor = stream_line(r->in);
+    return r->cursor ? 0 : -1;
+}
+
+static int ply_next(ply_reader_t* r, ply_type_t type, double* value) {
+    if (r->format != PLY_ASCII) return ply_read_binary(r->in, type, r->swap, value);
+    char* end;
+    *value = strtod(r->cursor, &end);
+    if (end == r->cursor) return -1;
+    r->cursor = end;
+    return 0;
+}
+
+static int ply_header(import_stream_t* in, ply_format_t* format, ply_element_t* elements, int* element_count) {
+    char* line = stream_line(in);
+    if (!line || strcmp(line, "ply") != 0) return -1;
+
+    *element_count = 0;
+    ply_element_t* current = NULL;
+    while ((line = stream_line(in)) != NULL) {
+        char word[32], a[32], b[32];
+        int n = sscanf(line, "%31s %31s %31s", word, a, b);
+        if (n < 1) continue;
+
+        if (strcmp(word, "end_header") == 0) {
+            return 0;
+        } else if (strcmp(word, "format") == 0 && n >= 2) {
+            if (strcmp(a, "ascii") == 0) *format = PLY_ASCII;
+            else if (strcmp(a, "binary_little_endian") == 0) *format = PLY_BINARY_LE;
+            else if (strcmp(a, "binary_big_endian") == 0) *format = PLY_BINARY_BE;
+            else return -1;
+        } else if (strcmp(word, "element") == 0 && n >= 3) {
+            if (*element_count == PLY_MAX_ELEMENTS) return -1;
+            current = &elements[(*element_count)++];
+            memset(current, 0, sizeof(*current));
+            snprintf(current->name, sizeof(current->name), "%s", a);
+            current->count = strtol(b, NULL, 10);
+            current->kind = strcmp(a, "vertex") == 0 ? 1 : strcmp(a, "face") == 0 ? 2 : strcmp(a, "edge") == 0 ? 3 : 0;
+            if (current->count < 0) return -1;
+        } else if (strcmp(word, "property") == 0 && current && n >= 3) {
+            if (current->property_count == PLY_MAX_PROPERTIES) return -1;
+            ply_property_t* prop = &current->properties[current->property_count++];
+            const char* name;
+            prop->role = -1;
+            if (strcmp(a, "list") == 0) {
+                // property list <count type> <item type> <name>
+                char list_name[32];
+                if (sscanf(line, "%*s %*s %31s %31s %31s", a, b, list_name) != 3) return -1;
+                prop->count_type = ply_type(a);
+                prop->type = ply_type(b);
+                if (prop->count_type == PLY_NONE) return -1;
+                name = list_name;
+                if (current->kind == 2 && (strcmp(name, "vertex_indices") == 0 || strcmp(name, "vertex_index") == 0)) {
+                    prop->role = 0;
+                }
+            } else {
+                prop->type = ply_type(a);
+                name = b;
+                if (current->kind == 1 && name[0] >= 'x' && name[0] <= 'z' && !name[1]) prop->role = name[0] - 'x';
+                if (current->kind == 3 && strcmp(name, "vertex1") == 0) prop->role = 0;
+                if (current->kind == 3 && strcmp(name, "vertex2") == 0) prop->role = 1;
+            }
+            if (prop->type == PLY_NONE) return -1;
+        }
+    }
+    return -1;
+}
+
+static int import_ply(import_stream_t* in, import_builder_t* b) {
+    ply_format_t format = PLY_ASCII;
+    ply_element_t elements[PLY_MAX_ELEMENTS];
+    int element_count = 0;
+    if (ply_header(in, &format, elements, &element_count) != 0) {
+        printf("ERROR: line %ld: bad PLY header\n", in->line);
+        return -1;
+    }
+
+    uint16_t probe = 1;
+    int little_host = *(unsigned char*)&probe == 1;
+    ply_reader_t reader = { in, format, 0, NULL };
+    reader.swap = (format == PLY_BINARY_LE && !little_host) || (format == PLY_BINARY_BE && little_host);
+
+    for (int e = 0; e < element_count; e++) {
+        ply_element_t* element = &elements[e];
+        if (element->kind == 1) {
+            // Counts come from the header: the total must stay an int index
+            if (element->count > INT_MAX - b->vert_count) {
+                printf("ERROR: bad PLY header: %ld vertices\n", element->count);
+                return -1;
+            }
+            if (builder_reserve_verts(b, b->vert_count + element->count) != 0) goto out_of_memory;
+        }
+
+        for (long i = 0; i < element->count; i++) {
+            double xyz[3] = { 0.0, 0.0, 0.0 };
+            int ends[2] = { -1, -1 };
+            if (ply_begin_element(&reader) != 0) goto truncated;
+
+            for (int p = 0; p < element->property_count; p++) {
+                const ply_property_t* prop = &element->properties[p];
+                double value;
+                if (prop->count_type == PLY_NONE) {
+                    if (ply_next(&reader, prop->type, &value) != 0) goto truncated;
+                    if (element->kind == 1 && prop->role >= 0) xyz[prop->role] = value;
+                    if (element->kind == 3 && prop->role >= 0) ends[prop->role] = (int)value;
+                    continue;
+                }
+
+                // List: a face loop when it holds the vertex indices, skipped otherwise
+                double count;
+                if (ply_next(&reader, prop->count_type, &count) != 0 || count < 0) goto truncated;
+                int first = -1, prev = -1;
+                for (long k = 0; k < (long)count; k++) {
+                    if (ply_next(&reader, prop->type, &value) != 0) goto truncated;
+                    if (prop->role < 0) continue;
+                    int index = (int)value;
+                    if (index < 0 || index >= b->vert_count) goto bad_index;
+                    if (prev >= 0 && builder_add_edge(b, prev, index) != 0) return -1;
+                    if (first < 0) first = index;
+                    prev = index;
+                }
+                if (first >= 0 && builder_add_edge(b, prev, first) != 0) return -1;
+            }
+
+            if (element->kind == 1) {
+                if (builder_add_vert(b, (float)xyz[0], (float)xyz[1], (float)xyz[2]) != 0) goto out_of_memory;
+            } else if (element->kind == 3 && (ends[0] >= 0 || ends[1] >= 0)) {
+                if (ends[0] < 0 || ends[1] < 0 || ends[0] >= b->vert_count || ends[1] >= b->vert_count) goto bad_index;
+                if (builder_add_edge(b, ends[0], ends[1]) != 0) return -1;
+            }
+        }
+    }
+    return 0;
+
+truncated:
+    printf("ERROR: PLY data ends early or is malformed\n");
+    return -1;
+bad_index:
+    printf("ERROR: PLY vertex index out of range\n");
+    return -1;
+out_of_memory:
+    printf("ERROR: Out of memory reading PLY vertices\n");
+    return -1;
+}
+
+// --- Entry points ---
+
+static int has_extension(const char* filename, const char* ext) {
+    size_t len = strlen(filename), ext_len = strlen(ext);
+    if (len < ext_len) return 0;
+    const char* tail = filename + len - ext_len;
+    for (size_t i = 0; i < ext_len; i++) {
+        if (tolower((unsigned char)tail[i]) != ext[i]) return 0;
+    }
+    return 1;
+}
+
+mesh_t* mesh_import(const char* filename) {
+    if (!filename) return NULL;
+    int ply = has_extension(filename, ".ply");
+    if (!ply && !has_extension(filename, ".obj")) {
+        printf("ERROR: %s: expected an .obj or .ply file\n", filename);
+        return NULL;
+    }
+
+    import_stream_t in;
+    if (stream_open(&in, filename) != 0) {
+        printf("ERROR: Cannot open %s\n", filename);
+        return NULL;
+    }
+    import_builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+
+    int status = ply ? import_ply(&in, &builder) : import_obj(&in, &builder);
+    stream_close(&in);
+    mesh_t* mesh = status == 0 ? builder_finish(&builder) : NULL;
+    builder_free(&builder);
+    if (status == 0 && !mesh) printf("ERROR: Out of memory importing %s\n", filename);
+    return mesh;
+}
+
+// --- Cache ---
+
+// Appended after the mesh_save data; mesh_load ignores bytes past file_size
+typedef struct {
+    char magic[8];          // "T3DSRC"
+    int64_t size;           // source size in bytes
+    int64_t mtime_ns;       // source modification time
+} import_stamp_t;
+
+static const char stamp_magic[8] = "T3DSRC";
+
+static void source_stamp(const struct stat* st, import_stamp_t* stamp) {
+    memset(stamp, 0, sizeof(*stamp));
+    memcpy(stamp->magic, stamp_magic, sizeof(stamp->magic));
+    stamp->size = (int64_t)st->st_size;
+#if defined(_WIN32)
+    stamp->mtime_ns = (int64_t)st->st_mtime * 1000000000LL;
+#elif defined(__APPLE__)
+    stamp->mtime_ns = (int64_t)st->st_mtimespec.tv_sec * 1000000000LL + st->st_mtimespec.tv_nsec;
+#else
+    stamp->mtime_ns = (int64_t)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+#endif
+}
+
+// 1 when the cache ends with exactly this stamp
+static int cache_matches(const char* cache_filename, const import_stamp_t* expected) {
+    FILE* file = fopen(cache_filename, "rb");
+    if (!file) return 0;
+    import_stamp_t stamp;
+    int ok = fseek(file, -(long)sizeof(stamp), SEEK_END) == 0 && fread(&stamp, sizeof(stamp), 1, file) == 1 &&
+             memcmp(&stamp, expected, sizeof(stamp)) == 0;
+    fclose(file);
+    return ok;
+}
+
+mesh_t* mesh_import_cached(const char* filename, const char* cache_filename) {
+    struct stat st;
+    import_stamp_t stamp;
+    int stamped = stat(filename, &st) == 0;
+    if (stamped) source_stamp(&st, &stamp);
+    if (cache_filename && stamped && cache_matches(cache_filename, &stamp)) {
+        mesh_t* mesh = mesh_load(cache_filename);
+        if (mesh) return mesh;
+    }
+
+    mesh_t* mesh = mesh_import(filename);
+    if (mesh && cache_filename) {
+        int failed = mesh_save(mesh, cache_filename) != 0;
+        FILE* file = failed || !stamped ? NULL : fopen(cache_filename, "ab");
+        if (file) {
+            failed = fwrite(&stamp, sizeof(stamp), 1, file) != 1;
+            failed |= fclose(file) != 0;
+        }
+        if (failed) {
+            printf("Warning: Cannot write mesh cache %s\n", cache_filename);
+            remove(cache_filename);
+        }
+    }
+    return mesh;
+}
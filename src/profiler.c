@@ -0,0 +1,171 @@
+// profiler.c - Per-stage frame profiler with counters and percentile summaries
+#define _POSIX_C_SOURCE 199309L
+
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static const char* stage_names[PROF_STAGE_COUNT] = {
+    "transform", "sort", "lighting", "raster", "export"
+};
+
+static const char* counter_names[PROF_COUNTER_COUNT] = {
+    "pixels_written", "lines_drawn", "lines_culled", "bytes_written"
+};
+
+// One recorded frame
+typedef struct {
+    uint64_t stage_ns[PROF_STAGE_COUNT];
+    uint64_t counters[PROF_COUNTER_COUNT];
+} prof_frame_t;
+
+// Percentile summary of one metric over all frames
+typedef struct {
+    uint64_t p50, p90, p99, max, total;
+} prof_summary_t;
+
+uint64_t prof_frame_stage_ns[PROF_STAGE_COUNT];
+uint64_t prof_frame_counters[PROF_COUNTER_COUNT];
+
+static prof_frame_t* frames = NULL;
+static int frame_count = 0;
+static int frame_capacity = 0;
+
+uint64_t profiler_now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void profiler_begin_frame(void) {
+    memset(prof_frame_stage_ns, 0, sizeof(prof_frame_stage_ns));
+    memset(prof_frame_counters, 0, sizeof(prof_frame_counters));
+}
+
+void profiler_end_frame(void) {
+    if (frame_count == frame_capacity) {
+        int new_capacity = frame_capacity ? frame_capacity * 2 : 256;
+        prof_frame_t* grown = realloc(frames, new_capacity * sizeof(prof_frame_t));
+        if (!grown) return;  // Drop the sample rather than abort the render
+        frames = grown;
+        frame_capacity = new_capacity;
+    }
+
+    prof_frame_t* f = &frames[frame_count++];
+    memcpy(f->stage_ns, prof_frame_stage_ns, sizeof(prof_frame_stage_ns));
+    memcpy(f->counters, prof_frame_counters, sizeof(prof_frame_counters));
+}
+
+void profiler_reset(void) {
+    free(frames);
+    frames = NULL;
+    frame_count = 0;
+    frame_capacity = 0;
+    profiler_begin_frame();
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile over a sorted array
+static uint64_t percentile(const uint64_t* sorted, int n, int pct) {
+    int rank = (pct * n + 99) / 100;
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+// Summarise metric 'index' (stages first, then counters) over all frames
+static prof_summary_t summarise(int index, uint64_t* scratch) {
+    prof_summary_t s = { 0 };
+    if (frame_count == 0) return s;
+
+    for (int i = 0; i < frame_count; i++) {
+        scratch[i] = (index < PROF_STAGE_COUNT)
+            ? frames[i].stage_ns[index]
+            : frames[i].counters[index - PROF_STAGE_COUNT];
+        s.total += scratch[i];
+    }
+    qsort(scratch, frame_count, sizeof(uint64_t), compare_u64);
+
+    s.p50 = percentile(scratch, frame_count, 50);
+    s.p90 = percentile(scratch, frame_count, 90);
+    s.p99 = percentile(scratch, frame_count, 99);
+    s.max = scratch[frame_count - 1];
+    return s;
+}
+
+static const char* metric_name(int index) {
+    return (index < PROF_STAGE_COUNT) ? stage_names[index] : counter_names[index - PROF_STAGE_COUNT];
+}
+
+int profiler_dump_csv(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) return -1;
+
+    uint64_t* scratch = malloc((frame_count > 0 ? frame_count : 1) * sizeof(uint64_t));
+    if (!scratch) {
+        fclose(file);
+        return -1;
+    }
+
+    fprintf(file, "metric,unit,frames,p50,p90,p99,max,total\n");
+    for (int i = 0; i < PROF_STAGE_COUNT + PROF_COUNTER_COUNT; i++) {
+        prof_summary_t s = summarise(i, scratch);
+        fprintf(file, "%s,%s,%d,%llu,%llu,%llu,%llu,%llu\n",
+                metric_name(i), (i < PROF_STAGE_COUNT) ? "ns" : "count", frame_count,
+                (unsigned long long)s.p50, (unsigned long long)s.p90, (unsigned long long)s.p99,
+                (unsigned long long)s.max, (unsigned long long)s.total);
+    }
+
+    free(scratch);
+    fclose(file);
+    return 0;
+}
+
+int profiler_dump_json(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) return -1;
+
+    uint64_t* scratch = malloc((frame_count > 0 ? frame_count : 1) * sizeof(uint64_t));
+    if (!scratch) {
+        fclose(file);
+        return -1;
+    }
+
+    fprintf(file, "{\n  \"frames\": %d,\n", frame_count);
+    for (int i = 0; i < PROF_STAGE_COUNT + PROF_COUNTER_COUNT; i++) {
+        if (i == 0) fprintf(file, "  \"stages_ns\": {\n");
+        if (i == PROF_STAGE_COUNT) fprintf(file, "  \"counters\": {\n");
+
+        prof_summary_t s = summarise(i, scratch);
+        int last_in_group = (i == PROF_STAGE_COUNT - 1) || (i == PROF_STAGE_COUNT + PROF_COUNTER_COUNT - 1);
+        fprintf(file, "    \"%s\": {\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"total\": %llu}%s\n",
+                metric_name(i),
+                (unsigned long long)s.p50, (unsigned long long)s.p90, (unsigned long long)s.p99,
+                (unsigned long long)s.max, (unsigned long long)s.total,
+                last_in_group ? "" : ",");
+
+        if (i == PROF_STAGE_COUNT - 1) fprintf(file, "  },\n");
+    }
+    fprintf(file, "  }\n}\n");
+
+    free(scratch);
+    fclose(file);
+    return 0;
+}
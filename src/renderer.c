@@ -3,9 +3,11 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "canvas.h"
 #include "math3d.h"
 #include "renderer.h"
+#include "profiler.h"
 
 /*************  ✨ Windsurf Command ⭐  *************/
 /**
@@ -25,7 +27,9 @@
 
 vec3_t project_vertex(vec3_t v, mat4_t mvp, int width, int height) {
     // Debug: Print input vertex
+    #ifdef DEBUG
     printf("Projecting vertex: (%.2f, %.2f, %.2f)\n", v.x, v.y, v.z);
+    #endif
     
     // Step 1: Apply Model-View-Projection transformation
     float x = v.x, y = v.y, z = v.z;
@@ -36,7 +40,9 @@ vec3_t project_vertex(vec3_t v, mat4_t mvp, int width, int height) {
     float transformed_z = mvp.m[2] * x + mvp.m[6] * y + mvp.m[10] * z + mvp.m[14];
     float w = mvp.m[3] * x + mvp.m[7] * y + mvp.m[11] * z + mvp.m[15];
 
+    #ifdef DEBUG
     printf("After transformation: (%.2f, %.2f, %.2f, %.2f)\n", transformed_x, transformed_y, transformed_z, w);
+    #endif
 
     // Perspective divide
     vec3_t ndc = {transformed_x, transformed_y, transformed_z};
@@ -46,7 +52,9 @@ vec3_t project_vertex(vec3_t v, mat4_t mvp, int width, int height) {
         ndc.z /= w;
     }
 
+    #ifdef DEBUG
     printf("NDC coordinates: (%.2f, %.2f, %.2f)\n", ndc.x, ndc.y, ndc.z);
+    #endif
 
     // Step 2: Map from NDC [-1, 1] to canvas [0, width/height]
     vec3_t screen = {
@@ -55,18 +63,21 @@ vec3_t project_vertex(vec3_t v, mat4_t mvp, int width, int height) {
         ndc.z  // depth, used for Z-sorting
     };
 
+    #ifdef DEBUG
     printf("Screen coordinates: (%.2f, %.2f, %.2f)\n\n", screen.x, screen.y, screen.z);
+    #endif
 
     return screen;
 }
 
-bool clip_to_circular_viewport(canvas_t* canvas, float x, float y) {
+// Circular viewport of a width x height image
+static bool inside_circular_viewport(int width, int height, float x, float y) {
     // Compute center of the canvas
-    float cx = (float)(canvas->width - 1) / 2.0f;
-    float cy = (float)(canvas->height - 1) / 2.0f;
+    float cx = (float)(width - 1) / 2.0f;
+    float cy = (float)(height - 1) / 2.0f;
 
     // Radius is half the smallest dimension
-    float radius = fminf(canvas->width, canvas->height) / 2.0f;
+    float radius = fminf(width, height) / 2.0f;
 
     // Distance from center
     float dx = x - cx;
@@ -76,12 +87,18 @@ bool clip_to_circular_viewport(canvas_t* canvas, float x, float y) {
     // Compare with radius^2
     bool inside = distance_squared <= (radius * radius);
     
+    #ifdef DEBUG
     printf("Clipping check: (%.2f, %.2f) -> %s (dist=%.2f, radius=%.2f)\n", 
            x, y, inside ? "INSIDE" : "OUTSIDE", sqrtf(distance_squared), radius);
+    #endif
     
     return inside;
 }
 
+bool clip_to_circular_viewport(canvas_t* canvas, float x, float y) {
+    return inside_circular_viewport(canvas->width, canvas->height, x, y);
+}
+
 // Depth comparator (back-to-front)
 int compare_edges(const void* a, const void* b) {
     float z1 = ((edge_depth_t*)a)->depth;
@@ -89,42 +106,66 @@ int compare_edges(const void* a, const void* b) {
     return (z1 < z2) ? 1 : (z1 > z2) ? -1 : 0;
 }
 
-void render_wireframe(canvas_t* canvas, vec3_t* verts, int vert_count, int edges[][2], int edge_count, mat4_t mvp) {
-    printf("=== Starting wireframe render ===\n");
-    printf("Vertex count: %d, Edge count: %d\n", vert_count, edge_count);
-    printf("Canvas size: %dx%d\n", canvas->width, canvas->height);
-    
-    int width = canvas->width;
-    int height = canvas->height;
-
+// Project vertices for a width x height image into a new array; NULL if
+// allocation failed
+static vec3_t* project_points(int width, int height, vec3_t* verts, int vert_count, mat4_t mvp) {
     // FIX: Allocate for ALL vertices, not edge_count * 2
     vec3_t* projected = malloc(sizeof(vec3_t) * vert_count);
     if (!projected) {
         printf("ERROR: Failed to allocate projected vertices\n");
-        return;
-    }
-
-    // Initialize all projected vertices
-    for (int i = 0; i < vert_count; i++) {
-        projected[i] = vec3_from_cartesian(0, 0, 0);
+        return NULL;
     }
 
     // Project all vertices (do this once)
+    #ifdef DEBUG
     printf("Projecting %d vertices...\n", vert_count);
+    #endif
+    PROF_BEGIN(PROF_STAGE_TRANSFORM);
     for (int i = 0; i < vert_count; i++) {
+        #ifdef DEBUG
         printf("Vertex %d: ", i);
+        #endif
         projected[i] = project_vertex(verts[i], mvp, width, height);
     }
+    PROF_END(PROF_STAGE_TRANSFORM);
+    return projected;
+}
+
+void project_mesh_vertices(const mesh_t* mesh, mat4_t mvp, int width, int height, vec3_t* out) {
+    PROF_BEGIN(PROF_STAGE_TRANSFORM);
+    for (int i = 0; i < mesh->vert_count; i++) {
+        vec3_t v = { mesh->px[i], mesh->py[i], mesh->pz[i], 0.0f, 0.0f, 0.0f };
+        out[i] = project_vertex(v, mvp, width, height);
+    }
+    PROF_END(PROF_STAGE_TRANSFORM);
+}
+
+static vec3_t* project_mesh_points(int width, int height, const mesh_t* mesh, mat4_t mvp) {
+    vec3_t* projected = malloc(sizeof(vec3_t) * mesh->vert_count);
+    if (!projected) {
+        printf("ERROR: Failed to allocate projected vertices\n");
+        return NULL;
+    }
+    project_mesh_vertices(mesh, mvp, width, height, projected);
+    return projected;
+}
 
+// List the edges to draw between projected vertices, back to front, without
+// those lying wholly outside the circular viewport of a width x height image.
+// Returns the number listed, or -1 if allocation failed.
+static int prepare_edges(int width, int height, const vec3_t* projected, int vert_count, int edges[][2],
+                         int edge_count, edge_depth_t** sorted_out) {
     // Store edges with average depth
     edge_depth_t* sorted_edges = malloc(sizeof(edge_depth_t) * edge_count);
     if (!sorted_edges) {
         printf("ERROR: Failed to allocate sorted edges\n");
-        free(projected);
-        return;
+        return -1;
     }
 
+    #ifdef DEBUG
     printf("Processing %d edges...\n", edge_count);
+    #endif
+    int valid = 0;
     for (int i = 0; i < edge_count; i++) {
         int i0 = edges[i][0];
         int i1 = edges[i][1];
@@ -143,95 +184,237 @@ void render_wireframe(canvas_t* canvas, vec3_t* verts, int vert_count, int edges
         float logz0 = logf(fabsf(z0) + 1e-3f);
         float logz1 = logf(fabsf(z1) + 1e-3f);
 
-        sorted_edges[i] = (edge_depth_t){
+        sorted_edges[valid++] = (edge_depth_t){
             .i0 = i0,
             .i1 = i1,
             .depth = (logz0 + logz1) / 2.0f
         };
         
-        printf("Edge %d: vertices %d->%d, depth %.2f\n", i, i0, i1, sorted_edges[i].depth);
+        #ifdef DEBUG
+        printf("Edge %d: vertices %d->%d, depth %.2f\n", i, i0, i1, sorted_edges[valid - 1].depth);
+        #endif
     }
 
     // Sort edges from back to front
-    qsort(sorted_edges, edge_count, sizeof(edge_depth_t), compare_edges);
+    PROF_BEGIN(PROF_STAGE_SORT);
+    qsort(sorted_edges, valid, sizeof(edge_depth_t), compare_edges);
+    PROF_END(PROF_STAGE_SORT);
+
+    // MODIFIED: Only skip if BOTH points are outside (allow partial clipping)
+    int kept = 0;
+    for (int i = 0; i < valid; i++) {
+        vec3_t p0 = projected[sorted_edges[i].i0];
+        vec3_t p1 = projected[sorted_edges[i].i1];
+        if (!inside_circular_viewport(width, height, p0.x, p0.y) &&
+            !inside_circular_viewport(width, height, p1.x, p1.y)) {
+            PROF_COUNT(PROF_COUNTER_LINES_CULLED, 1);
+            #ifdef DEBUG
+            printf("Edge %d -> Skipped (both points outside)\n", i);
+            #endif
+            continue;
+        }
+        sorted_edges[kept++] = sorted_edges[i];
+    }
+
+    *sorted_out = sorted_edges;
+    return kept;
+}
+
+// Depth-sorted draw of vertices already in screen space
+static void render_projected(canvas_t* canvas, const vec3_t* projected, int vert_count, int edges[][2], int edge_count) {
+    #ifdef DEBUG
+    printf("=== Starting wireframe render ===\n");
+    printf("Vertex count: %d, Edge count: %d\n", vert_count, edge_count);
+    printf("Canvas size: %dx%d\n", canvas->width, canvas->height);
+    #endif
+    
+    edge_depth_t* sorted_edges;
+    int count = prepare_edges(canvas->width, canvas->height, projected, vert_count, edges, edge_count, &sorted_edges);
+    if (count < 0) return;
 
     // Draw sorted edges
-    int drawn_edges = 0;
+    #ifdef DEBUG
     printf("Drawing edges...\n");
-    for (int i = 0; i < edge_count; i++) {
-        int i0 = sorted_edges[i].i0;
-        int i1 = sorted_edges[i].i1;
-
-        vec3_t p0 = projected[i0];
-        vec3_t p1 = projected[i1];
+    #endif
+    for (int i = 0; i < count; i++) {
+        vec3_t p0 = projected[sorted_edges[i].i0];
+        vec3_t p1 = projected[sorted_edges[i].i1];
 
+        #ifdef DEBUG
         printf("Drawing edge %d: (%.1f,%.1f) -> (%.1f,%.1f)\n", i, p0.x, p0.y, p1.x, p1.y);
-
-        // MODIFIED: Only skip if BOTH points are outside (allow partial clipping)
-        bool p0_inside = clip_to_circular_viewport(canvas, p0.x, p0.y);
-        bool p1_inside = clip_to_circular_viewport(canvas, p1.x, p1.y);
-        
-        if (!p0_inside && !p1_inside) {
-            printf("  -> Skipped (both points outside)\n");
-            continue;
-        }
+        #endif
 
         // Draw the line
-        draw_line_f(canvas, p0.x, p0.y, p1.x, p1.y, 1.4f);
-        drawn_edges++;
-        printf("  -> Drawn\n");
+        draw_line_f(canvas, p0.x, p0.y, p1.x, p1.y, RENDER_LINE_THICKNESS);
     }
 
-    printf("Total edges drawn: %d/%d\n", drawn_edges, edge_count);
+    #ifdef DEBUG
+    printf("Total edges drawn: %d/%d\n", count, edge_count);
     printf("=== Wireframe render complete ===\n\n");
+    #endif
+
+    free(sorted_edges);
+}
+
+void render_wireframe(canvas_t* canvas, vec3_t* verts, int vert_count, int edges[][2], int edge_count, mat4_t mvp) {
+    vec3_t* projected = project_points(canvas->width, canvas->height, verts, vert_count, mvp);
+    if (!projected) return;
+    render_projected(canvas, projected, vert_count, edges, edge_count);
+    free(projected);
+}
 
+void render_wireframe_mesh(canvas_t* canvas, const mesh_t* mesh, mat4_t mvp) {
+    vec3_t* projected = project_mesh_points(canvas->width, canvas->height, mesh, mvp);
+    if (!projected) return;
+    render_projected(canvas, projected, mesh->vert_count, mesh->edges, mesh->edge_count);
     free(projected);
+}
+
+// Bands a visible edge of a strip render touches
+typedef struct {
+    int edge;     // index into the depth-sorted edges
+    int first;
+    int last;
+} band_span_t;
+
+// By first band, then back to front
+static int compare_spans(const void* a, const void* b) {
+    const band_span_t* sa = a;
+    const band_span_t* sb = b;
+    if (sa->first != sb->first) return sa->first < sb->first ? -1 : 1;
+    return (sa->edge > sb->edge) - (sa->edge < sb->edge);
+}
+
+// Band-by-band draw of vertices already in screen space
+static int render_projected_strips(int width, int height, int band_height, const vec3_t* projected, int vert_count,
+                                   int edges[][2], int edge_count, render_strip_fn emit, void* user) {
+    if (band_height > height) band_height = height;
+    int bands = (height + band_height - 1) / band_height;
+
+    edge_depth_t* sorted_edges;
+    int count = prepare_edges(width, height, projected, vert_count, edges, edge_count, &sorted_edges);
+    if (count < 0) return -1;
+
+    // Each edge's stamps reach image rows top..bottom (half the thickness
+    // either side, a splat row below, and a row of slack): bands first..last.
+    // Visible edges are ordered by first band, then depth.
+    band_span_t* spans = malloc(sizeof(band_span_t) * (count > 0 ? count : 1));
+    int* active = malloc(sizeof(int) * (count > 0 ? count : 1));
+    int* merged = malloc(sizeof(int) * (count > 0 ? count : 1));
+    canvas_t* strip = canvas_create(width, band_height);
+    int failed = !spans || !active || !merged || !strip;
+    if (failed) printf("ERROR: Failed to allocate strip buffers\n");
+
+    int visible = 0;
+    for (int i = 0; i < count && !failed; i++) {
+        float y0 = projected[sorted_edges[i].i0].y;
+        float y1 = projected[sorted_edges[i].i1].y;
+        float top = fminf(y0, y1) - RENDER_LINE_THICKNESS / 2.0f - 2.0f;
+        float bottom = fmaxf(y0, y1) + RENDER_LINE_THICKNESS / 2.0f + 2.0f;
+        if (!(bottom >= 0.0f && top < height)) continue;
+        spans[visible].edge = i;
+        spans[visible].first = top <= 0.0f ? 0 : (int)top / band_height;
+        spans[visible].last = bottom >= height - 1 ? bands - 1 : (int)bottom / band_height;
+        visible++;
+    }
+    if (!failed) qsort(spans, visible, sizeof(band_span_t), compare_spans);
+
+    // Rasterize and hand over each band in turn through the one strip buffer.
+    // The active list holds the edges crossing the band in depth order: edges
+    // that end above it drop out and those starting at it are merged in.
+    int active_count = 0;
+    int next = 0;
+    for (int b = 0; b < bands && !failed; b++) {
+        int kept = 0;
+        for (int k = 0; k < active_count || (next < visible && spans[next].first == b);) {
+            int take_new = next < visible && spans[next].first == b &&
+                           (k == active_count || spans[next].edge < spans[active[k]].edge);
+            int s = take_new ? next++ : active[k++];
+            if (spans[s].last >= b) merged[kept++] = s;
+        }
+        int* swap = active;
+        active = merged;
+        merged = swap;
+        active_count = kept;
+
+        canvas_clear(strip);
+        strip->origin_y = b * band_height;
+        for (int k = 0; k < active_count; k++) {
+            vec3_t p0 = projected[sorted_edges[spans[active[k]].edge].i0];
+            vec3_t p1 = projected[sorted_edges[spans[active[k]].edge].i1];
+            draw_line_f(strip, p0.x, p0.y, p1.x, p1.y, RENDER_LINE_THICKNESS);
+        }
+        int rows = height - strip->origin_y < band_height ? height - strip->origin_y : band_height;
+        if (emit(strip, rows, user) != 0) failed = 1;
+    }
+
+    canvas_destroy(strip);
+    free(merged);
+    free(active);
+    free(spans);
     free(sorted_edges);
+    return failed ? -1 : 0;
+}
+
+int render_wireframe_strips(int width, int height, int band_height, vec3_t* verts, int vert_count,
+                            int edges[][2], int edge_count, mat4_t mvp, render_strip_fn emit, void* user) {
+    if (width <= 0 || height <= 0 || band_height <= 0 || !emit) return -1;
+    vec3_t* projected = project_points(width, height, verts, vert_count, mvp);
+    if (!projected) return -1;
+    int status = render_projected_strips(width, height, band_height, projected, vert_count, edges, edge_count, emit, user);
+    free(projected);
+    return status;
+}
+
+int render_wireframe_mesh_strips(int width, int height, int band_height, const mesh_t* mesh, mat4_t mvp,
+                                 render_strip_fn emit, void* user) {
+    if (width <= 0 || height <= 0 || band_height <= 0 || !emit) return -1;
+    vec3_t* projected = project_mesh_points(width, height, mesh, mvp);
+    if (!projected) return -1;
+    int status = render_projected_strips(width, height, band_height, projected, mesh->vert_count, mesh->edges,
+                                         mesh->edge_count, emit, user);
+    free(projected);
+    return status;
+}
+
+static int emit_pgm_rows(const canvas_t* strip, int rows, void* file) {
+    return canvas_write_pgm_rows(strip, file, rows);
+}
+
+int render_wireframe_pgm(const char* filename, int width, int height, int band_height, vec3_t* verts,
+                         int vert_count, int edges[][2], int edge_count, mat4_t mvp) {
+    FILE* file = fopen(filename, "w");
+    if (!file) return -1;
+    canvas_write_pgm_header(file, width, height);
+    int failed = render_wireframe_strips(width, height, band_height, verts, vert_count, edges, edge_count, mvp,
+                                         emit_pgm_rows, file);
+    failed |= ferror(file);
+    failed |= fclose(file);
+    return failed ? -1 : 0;
+}
+
+mat4_t look_rotation_to_mat4(quat_t q) {
+    // Negating the right row is the mirror no quaternion can hold
+    mat4_t m = quat_to_mat4(q);
+    m.m[0] = -m.m[0];
+    m.m[4] = -m.m[4];
+    m.m[8] = -m.m[8];
+    return m;
 }
 
 // Apply smooth quaternion-based rotation (SLERP between two directions)
 mat4_t apply_quaternion_rotation(vec3_t from, vec3_t to, float t) {
+    #ifdef DEBUG
     printf("Applying quaternion rotation with t=%.2f\n", t);
-    
-    // Normalize both
-    from = vec3_normalize_fast(from);
-    to   = vec3_normalize_fast(to);
-
-    // Slerp between the two
-    vec3_t forward = vec3_slerp(from, to, t);
-    forward = vec3_normalize_fast(forward);
-
-    // Avoid degenerate 'up' when forward is close to Y
-    vec3_t world_up = {0, 1, 0};
-    if (fabsf(forward.x) < 1e-3 && fabsf(forward.z) < 1e-3)
-        world_up = (vec3_t){0, 0, 1};
-
-    // Right = up × forward
-    vec3_t right = {
-        world_up.y * forward.z - world_up.z * forward.y,
-        world_up.z * forward.x - world_up.x * forward.z,
-        world_up.x * forward.y - world_up.y * forward.x
-    };
-    right = vec3_normalize_fast(right);
+    #endif
 
-    // Recompute true up = forward × right
-    vec3_t up = {
-        forward.y * right.z - forward.z * right.y,
-        forward.z * right.x - forward.x * right.z,
-        forward.x * right.y - forward.y * right.x
-    };
-    up = vec3_normalize_fast(up);
-
-    // Final matrix
-    mat4_t result = {
-        .m = {
-            right.x,   up.x,   -forward.x,   0,
-            right.y,   up.y,   -forward.y,   0,
-            right.z,   up.z,   -forward.z,   0,
-            0,         0,       0,           1
-        }
-    };
+    // Orientations looking along each direction, slerped as quaternions
+    quat_t q_from = quat_look_rotation(vec3f_from_vec3(from));
+    quat_t q_to   = quat_look_rotation(vec3f_from_vec3(to));
+    mat4_t result = look_rotation_to_mat4(quat_slerp(q_from, q_to, t));
 
+    #ifdef DEBUG
     printf("Rotation matrix created\n");
+    #endif
     return result;
 }
\ No newline at end of file
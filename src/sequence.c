@@ -0,0 +1,285 @@
+// sequence.c
+#if !defined(_WIN32) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L  // st_mtim
+#endif
+
+#include "sequence.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#endif
+
+void sequence_init(sequence_t* seq, int fps, float duration, const char* output_dir) {
+    memset(seq, 0, sizeof(*seq));
+    seq->fps = fps > 0 ? fps : 30;
+    seq->duration = duration > 0.0f ? duration : 1.0f;
+    seq->total_frames = (int)(seq->fps * seq->duration + 0.5f);
+    seq->first_frame = 0;
+    seq->last_frame = seq->total_frames - 1;
+    seq->shard_index = 0;
+    seq->shard_count = 1;
+    seq->name_digits = 4;
+    snprintf(seq->output_dir, sizeof(seq->output_dir), "%s", output_dir ? output_dir : ".");
+}
+
+static void sequence_usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--fps <n>] [--duration <seconds>] [--frames <first>:<last>]\n"
+            "          [--shard <i>/<n>] [--out <dir>] [--resume] [--ring <name>]\n"
+            "  --frames takes inclusive absolute indices; either end may be omitted.\n"
+            "  --shard i/n renders every n-th frame of the range starting at its i-th.\n"
+            "  --resume skips frames already written by an earlier run of the same scene.\n"
+            "  --ring publishes frames to the shared-memory ring <name> instead of files.\n",
+            prog);
+}
+
+// Whole-string integer parse; end receives the first unparsed character
+static int parse_int(const char* text, int* value, const char** end) {
+    char* stop;
+    errno = 0;
+    long v = strtol(text, &stop, 10);
+    if (stop == text || errno != 0 || v < -2147483647L || v > 2147483647L) return -1;
+    *value = (int)v;
+    *end = stop;
+    return 0;
+}
+
+int sequence_parse_args(sequence_t* seq, int argc, char** argv) {
+    int first = 0, last = -1;
+    int have_last = 0;
+    const char* end;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--resume") == 0) {
+            seq->resume = 1;
+            continue;
+        }
+
+        const char* value = ++i < argc ? argv[i] : NULL;
+        int ok = value != NULL;
+        if (!ok) {
+            // Missing value
+        } else if (strcmp(arg, "--fps") == 0) {
+            ok = parse_int(value, &seq->fps, &end) == 0 && !*end && seq->fps > 0;
+        } else if (strcmp(arg, "--duration") == 0) {
+            char* stop;
+            seq->duration = strtof(value, &stop);
+            ok = stop != value && !*stop && seq->duration > 0.0f;
+        } else if (strcmp(arg, "--frames") == 0) {
+            // <first>:<last>, <first>: or :<last>
+            end = value;
+            if (*end != ':') ok = parse_int(value, &first, &end) == 0 && first >= 0;
+            ok = ok && *end == ':';
+            if (ok && end[1]) {
+                ok = parse_int(end + 1, &last, &end) == 0 && !*end;
+                have_last = 1;
+            }
+        } else if (strcmp(arg, "--shard") == 0) {
+            ok = parse_int(value, &seq->shard_index, &end) == 0 && *end == '/' &&
+                 parse_int(end + 1, &seq->shard_count, &end) == 0 && !*end &&
+                 seq->shard_count >= 1 && seq->shard_index >= 0 && seq->shard_index < seq->shard_count;
+        } else if (strcmp(arg, "--out") == 0) {
+            snprintf(seq->output_dir, sizeof(seq->output_dir), "%s", value);
+        } else if (strcmp(arg, "--ring") == 0) {
+            // POSIX shared-memory names start with a slash
+            snprintf(seq->ring_name, sizeof(seq->ring_name), "%s%s", value[0] == '/' ? "" : "/", value);
+        } else {
+            ok = 0;
+        }
+
+        if (!ok) {
+            sequence_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    seq->total_frames = (int)(seq->fps * seq->duration + 0.5f);
+    seq->first_frame = first;
+    seq->last_frame = have_last ? last : seq->total_frames - 1;
+    if (seq->last_frame > seq->total_frames - 1) seq->last_frame = seq->total_frames - 1;
+    if (seq->first_frame > seq->last_frame) {
+        fprintf(stderr, "%s: empty frame range %d:%d (sequence has %d frames)\n",
+                argv[0], first, seq->last_frame, seq->total_frames);
+        return -1;
+    }
+    return 0;
+}
+
+int sequence_first(const sequence_t* seq) {
+    return seq->first_frame + seq->shard_index;
+}
+
+int sequence_frame_count(const sequence_t* seq) {
+    int first = sequence_first(seq);
+    if (first > seq->last_frame) return 0;
+    return (seq->last_frame - first) / seq->shard_count + 1;
+}
+
+float sequence_time(const sequence_t* seq, int frame) {
+    // Same time base as a loop stepping by 1/fps, so shards match a full run
+    return frame * (1.0f / seq->fps);
+}
+
+void sequence_frame_path(const sequence_t* seq, int frame, char* out, size_t size) {
+    snprintf(out, size, "%s/frame_%0*d.pgm", seq->output_dir, seq->name_digits, frame);
+}
+
+int sequence_prepare_output(const sequence_t* seq) {
+    if (seq->ring_name[0]) return 0;
+    struct stat st;
+    if (stat(seq->output_dir, &st) == 0) return 0;
+    if (mkdir(seq->output_dir, 0755) != 0 && errno != EEXIST) {
+        printf("ERROR: Cannot create output directory %s\n", seq->output_dir);
+        return -1;
+    }
+    return 0;
+}
+
+int sequence_open_ring(sequence_t* seq, int width, int height) {
+    if (!seq->ring_name[0]) return 0;
+    seq->ring = frame_ring_create(seq->ring_name, width, height, SEQUENCE_RING_SLOTS);
+    return seq->ring ? 0 : -1;
+}
+
+void sequence_close(sequence_t* seq) {
+    frame_ring_close(seq->ring);
+    seq->ring = NULL;
+}
+
+// Rename over an existing file (Windows rename refuses to replace)
+static int replace_file(const char* from, const char* to) {
+#ifdef _WIN32
+    remove(to);
+#endif
+    if (rename(from, to) != 0) {
+        remove(from);
+        return -1;
+    }
+    return 0;
+}
+
+// Modification time in nanoseconds, to whatever resolution the platform keeps
+static long long file_time(const struct stat* st) {
+#if defined(_WIN32)
+    return (long long)st->st_mtime * 1000000000LL;
+#elif defined(__APPLE__)
+    return (long long)st->st_mtimespec.tv_sec * 1000000000LL + st->st_mtimespec.tv_nsec;
+#else
+    return (long long)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+#endif
+}
+
+// Manifest text for the scene; a frame range or shard is not part of it
+static void manifest_text(const sequence_t* seq, const char* scene, int width, int height, char* out, size_t size) {
+    snprintf(out, size, "scene %s\nwidth %d\nheight %d\nfps %d\nduration %.6g\ntotal_frames %d\n",
+             scene, width, height, seq->fps, seq->duration, seq->total_frames);
+}
+
+int sequence_sync_manifest(sequence_t* seq, const char* scene, int width, int height) {
+    if (seq->ring_name[0]) return 0;
+    char path[SEQUENCE_PATH_MAX + 32];
+    char expected[512];
+    char existing[512];
+    snprintf(path, sizeof(path), "%s/manifest.txt", seq->output_dir);
+    manifest_text(seq, scene, width, height, expected, sizeof(expected));
+
+    FILE* file = fopen(path, "rb");
+    size_t len = 0;
+    if (file) {
+        len = fread(existing, 1, sizeof(existing) - 1, file);
+        fclose(file);
+    }
+    existing[len] = '\0';
+    struct stat st;
+    if (file && strcmp(existing, expected) == 0) {
+        seq->manifest_ns = stat(path, &st) == 0 ? file_time(&st) : 0;
+        return 0;
+    }
+
+    if (seq->resume) {
+        printf("%s: %s, rendering all frames\n", path, file ? "scene changed" : "no manifest");
+        seq->resume = 0;
+    }
+
+    // Drop this shard's frames of the old scene before the new manifest
+    // vouches for the directory, so a run that dies early cannot leave them to
+    // be resumed. Other shards' frames are theirs to delete: they may already
+    // be rendering the new scene.
+    char frame_path[SEQUENCE_PATH_MAX + 32];
+    for (int frame = sequence_first(seq); frame <= seq->last_frame; frame += seq->shard_count) {
+        sequence_frame_path(seq, frame, frame_path, sizeof(frame_path));
+        remove(frame_path);
+    }
+
+    // Per-shard temporary name: shards may start at the same time
+    char tmp[SEQUENCE_PATH_MAX + 48];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, seq->shard_index);
+    file = fopen(tmp, "wb");
+    if (!file) {
+        printf("ERROR: Cannot write %s\n", tmp);
+        return -1;
+    }
+    int failed = fputs(expected, file) < 0;
+    failed |= fclose(file);
+    if (failed || replace_file(tmp, path) != 0) {
+        printf("ERROR: Cannot write %s\n", path);
+        return -1;
+    }
+    seq->manifest_ns = stat(path, &st) == 0 ? file_time(&st) : 0;
+    return 0;
+}
+
+int sequence_frame_done(const sequence_t* seq, int frame, int width, int height) {
+    if (!seq->resume || seq->ring_name[0]) return 0;
+
+    // Frames older than the manifest may belong to the scene it replaced
+    char path[SEQUENCE_PATH_MAX + 32];
+    sequence_frame_path(seq, frame, path, sizeof(path));
+    struct stat st;
+    if (stat(path, &st) != 0 || file_time(&st) < seq->manifest_ns) return 0;
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+
+    // Header as written by canvas_save_pgm
+    char header[64];
+    size_t got = fread(header, 1, sizeof(header) - 1, file);
+    header[got] = '\0';
+    int w = 0, h = 0, maxval = 0, header_len = 0;
+    int ok = sscanf(header, "P2\n%d %d\n%d\n%n", &w, &h, &maxval, &header_len) == 3 && header_len > 0 &&
+             w == width && h == height && maxval == 255;
+
+    // Every pixel is "<0-255> " and every row ends in a newline
+    if (ok && fseek(file, -1, SEEK_END) == 0) {
+        long size = ftell(file) + 1;
+        double pixels = (double)width * height;
+        ok = size >= header_len + 2.0 * pixels + height && size <= header_len + 4.0 * pixels + height &&
+             fgetc(file) == '\n';
+    } else {
+        ok = 0;
+    }
+    fclose(file);
+    return ok;
+}
+
+int sequence_save_frame(const sequence_t* seq, canvas_t* canvas, int frame) {
+    if (seq->ring) return frame_ring_publish(seq->ring, canvas, frame) < 0 ? -1 : 0;
+
+    char path[SEQUENCE_PATH_MAX + 32];
+    char tmp[SEQUENCE_PATH_MAX + 40];
+    sequence_frame_path(seq, frame, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    if (canvas_save_pgm(canvas, tmp) != 0 || replace_file(tmp, path) != 0) {
+        remove(tmp);
+        printf("ERROR: Cannot write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
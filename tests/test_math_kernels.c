@@ -0,0 +1,1435 @@
+// test_math_kernels.c - Checks the optimised math, lighting, raster and animation kernels against scalar references
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L  // fork, for frame ring crash tests
+#include <sys/wait.h>
+#include <unistd.h>
+#define TEST_FORK
+#endif
+
+#include <stdio.h>
+#include <math.h>
+#include "math3d.h"
+#include "mesh.h"
+#include "lighting.h"
+#include "canvas.h"
+#include "animation.h"
+#include "sequence.h"
+#include "mesh_import.h"
+#include "geometry.h"
+#include "frame_ring.h"
+#include "renderer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TOLERANCE 1e-5f
+
+static int failures = 0;
+
+static void check(int ok, const char* what) {
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static int nearly_equal(float a, float b) {
+    return fabsf(a - b) <= TOLERANCE * fmaxf(1.0f, fmaxf(fabsf(a), fabsf(b)));
+}
+
+static int mat4_nearly_equal(const mat4_t* a, const mat4_t* b) {
+    for (int i = 0; i < 16; i++) {
+        if (!nearly_equal(a->m[i], b->m[i])) return 0;
+    }
+    return 1;
+}
+
+// Reference triple loop (column-major)
+static mat4_t ref_multiply(const mat4_t* a, const mat4_t* b) {
+    mat4_t r;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int i = 0; i < 4; i++) sum += a->m[i * 4 + row] * b->m[col * 4 + i];
+            r.m[col * 4 + row] = sum;
+        }
+    }
+    return r;
+}
+
+// Reference Rz * Ry * Rx built from single-axis matrices
+static mat4_t ref_rotate_xyz(float rx, float ry, float rz) {
+    mat4_t x = mat4_identity(), y = mat4_identity(), z = mat4_identity();
+    x.m[5] = cosf(rx); x.m[6] = sinf(rx); x.m[9] = -sinf(rx); x.m[10] = cosf(rx);
+    y.m[0] = cosf(ry); y.m[2] = -sinf(ry); y.m[8] = sinf(ry); y.m[10] = cosf(ry);
+    z.m[0] = cosf(rz); z.m[1] = sinf(rz); z.m[4] = -sinf(rz); z.m[5] = cosf(rz);
+    mat4_t yx = ref_multiply(&y, &x);
+    return ref_multiply(&z, &yx);
+}
+
+static void test_mat4_kernels(void) {
+    mat4_t proj = mat4_frustum(-2.5f, 2.5f, -2.0f, 2.0f, 3.0f, 30.0f);
+    mat4_t model = mat4_multiply(mat4_translate(1.0f, -2.0f, 3.0f), mat4_rotate_xyz(0.3f, -1.2f, 2.1f));
+
+    mat4_t expected = ref_multiply(&proj, &model);
+    mat4_t got;
+    mat4_multiply_into(&got, &proj, &model);
+    check(mat4_nearly_equal(&expected, &got), "mat4_multiply_into matches scalar reference");
+
+    mat4_t by_value = mat4_multiply(proj, model);
+    check(mat4_nearly_equal(&expected, &by_value), "mat4_multiply matches scalar reference");
+
+    mat4_t aliased = proj;
+    mat4_multiply_into(&aliased, &aliased, &model);
+    check(mat4_nearly_equal(&expected, &aliased), "mat4_multiply_into with aliased output");
+
+    int rotate_ok = 1;
+    for (int i = 0; i < 64; i++) {
+        float rx = i * 0.37f - 5.0f, ry = i * 0.21f - 3.0f, rz = i * 0.13f + 1.0f;
+        mat4_t a = mat4_rotate_xyz(rx, ry, rz);
+        mat4_t b = ref_rotate_xyz(rx, ry, rz);
+        if (!mat4_nearly_equal(&a, &b)) rotate_ok = 0;
+    }
+    check(rotate_ok, "closed-form mat4_rotate_xyz matches Rz*Ry*Rx");
+}
+
+static void test_point_transforms(void) {
+    mat4_t mvp = mat4_multiply(mat4_frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 10.0f),
+                               mat4_multiply(mat4_translate(0.5f, 0.0f, -5.0f),
+                                             mat4_rotate_xyz(0.4f, 0.8f, -0.2f)));
+    vec3f_t in[37];
+    vec4_t out[37];
+    for (int i = 0; i < 37; i++) {
+        in[i] = vec3f_make(sinf(i * 0.7f) * 2.0f, cosf(i * 1.3f), i * 0.05f - 1.0f);
+    }
+    mat4_transform_points(&mvp, in, out, 37);  // odd count exercises the tail loop
+
+    int ok = 1;
+    for (int i = 0; i < 37; i++) {
+        vec4_t v = { in[i].x, in[i].y, in[i].z, 1.0f };
+        vec4_t r = mat4_mul_vec4(&mvp, v);
+        float ex = mvp.m[0] * v.x + mvp.m[4] * v.y + mvp.m[8]  * v.z + mvp.m[12];
+        float ew = mvp.m[3] * v.x + mvp.m[7] * v.y + mvp.m[11] * v.z + mvp.m[15];
+        if (!nearly_equal(r.x, ex) || !nearly_equal(r.w, ew)) ok = 0;
+        if (!nearly_equal(out[i].x, r.x) || !nearly_equal(out[i].y, r.y) ||
+            !nearly_equal(out[i].z, r.z) || !nearly_equal(out[i].w, r.w)) ok = 0;
+    }
+    check(ok, "mat4_transform_points and mat4_mul_vec4 agree with scalar projection");
+}
+
+static int quat_same_rotation(quat_t a, quat_t b) {
+    // q and -q describe the same rotation
+    float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    return nearly_equal(fabsf(dot), 1.0f);
+}
+
+static void test_quaternions(void) {
+    int euler_ok = 1, roundtrip_ok = 1;
+    for (int i = 0; i < 64; i++) {
+        float rx = i * 0.37f - 5.0f, ry = i * 0.21f - 3.0f, rz = i * 0.13f + 1.0f;
+        mat4_t expected = ref_rotate_xyz(rx, ry, rz);
+        quat_t q = quat_from_euler_xyz(rx, ry, rz);
+        mat4_t got = quat_to_mat4(q);
+        if (!mat4_nearly_equal(&expected, &got)) euler_ok = 0;
+        if (!quat_same_rotation(q, quat_from_mat4(&expected))) roundtrip_ok = 0;
+    }
+    check(euler_ok, "quat_from_euler_xyz + quat_to_mat4 match mat4_rotate_xyz");
+    check(roundtrip_ok, "quat_from_mat4 recovers the rotation");
+
+    quat_t qx = quat_from_axis_angle(vec3f_make(1.0f, 0.0f, 0.0f), 0.7f);
+    quat_t qy = quat_from_axis_angle(vec3f_make(0.0f, 2.0f, 0.0f), -0.4f);
+    mat4_t mx = quat_to_mat4(qx), my = quat_to_mat4(qy);
+    mat4_t expected = ref_multiply(&mx, &my);
+    mat4_t composed = quat_to_mat4(quat_multiply(qx, qy));
+    check(mat4_nearly_equal(&expected, &composed), "quat_multiply composes like mat4_multiply");
+
+    vec3f_t v = vec3f_make(0.3f, -1.1f, 2.0f);
+    vec3f_t rv = quat_rotate(qy, v);
+    vec4_t mv = mat4_mul_vec4(&my, (vec4_t){ v.x, v.y, v.z, 1.0f });
+    check(nearly_equal(rv.x, mv.x) && nearly_equal(rv.y, mv.y) && nearly_equal(rv.z, mv.z),
+          "quat_rotate matches quat_to_mat4");
+
+    vec3f_t axis = vec3f_make(0.2f, 1.0f, -0.5f);
+    quat_t a = quat_from_axis_angle(axis, 0.3f);
+    quat_t b = quat_from_axis_angle(axis, 2.1f);
+    int slerp_ok = quat_same_rotation(quat_slerp(a, b, 0.0f), a) &&
+                   quat_same_rotation(quat_slerp(a, b, 1.0f), b) &&
+                   quat_same_rotation(quat_slerp(a, b, 0.25f), quat_from_axis_angle(axis, 0.75f));
+    check(slerp_ok, "quat_slerp interpolates angle linearly about a shared axis");
+
+    quat_t neg_b = { -b.x, -b.y, -b.z, -b.w };
+    check(quat_same_rotation(quat_slerp(a, neg_b, 0.5f), quat_from_axis_angle(axis, 1.2f)) &&
+          quat_same_rotation(quat_nlerp(a, neg_b, 0.5f), quat_from_axis_angle(axis, 1.2f)),
+          "quat_slerp/quat_nlerp take the shortest arc");
+
+    // Look rotation: rows right, up, -forward
+    vec3f_t fwd = vec3f_normalize(vec3f_make(1.0f, 0.5f, -1.0f));
+    mat4_t look = quat_to_mat4(quat_look_rotation(fwd));
+    check(nearly_equal(look.m[2], -fwd.x) && nearly_equal(look.m[6], -fwd.y) &&
+          nearly_equal(look.m[10], -fwd.z) && fabsf(look.m[4]) < TOLERANCE,
+          "quat_look_rotation maps forward to -Z with a level right axis");
+}
+
+// The look-at matrix apply_quaternion_rotation built before quaternions: the
+// slerped direction with right = up x forward, rows right, up, -forward
+static mat4_t ref_look_at(vec3f_t from, vec3f_t to, float t) {
+    from = vec3f_normalize(from);
+    to = vec3f_normalize(to);
+    float angle = acosf(fmaxf(-1.0f, fminf(1.0f, vec3f_dot(from, to))));
+    vec3f_t forward = from;
+    if (angle > 1e-6f) {
+        float wa = sinf((1.0f - t) * angle) / sinf(angle), wb = sinf(t * angle) / sinf(angle);
+        forward = vec3f_normalize(vec3f_make(from.x * wa + to.x * wb, from.y * wa + to.y * wb, from.z * wa + to.z * wb));
+    }
+    vec3f_t world_up = vec3f_make(0.0f, 1.0f, 0.0f);
+    if (fabsf(forward.x) < 1e-3f && fabsf(forward.z) < 1e-3f) world_up = vec3f_make(0.0f, 0.0f, 1.0f);
+    vec3f_t right = vec3f_normalize(vec3f_cross(world_up, forward));
+    vec3f_t up = vec3f_cross(forward, right);
+    mat4_t m = mat4_identity();
+    m.m[0] = right.x; m.m[4] = right.y; m.m[8]  = right.z;
+    m.m[1] = up.x;    m.m[5] = up.y;    m.m[9]  = up.z;
+    m.m[2] = -forward.x; m.m[6] = -forward.y; m.m[10] = -forward.z;
+    return m;
+}
+
+static void test_look_rotation(void) {
+    // Endpoints of any pair, and every step between directions sharing the
+    // world up axis (the demo's sweep), keep the old convention
+    vec3_t dirs[] = { vec3_from_cartesian(-1.0f, 0.0f, -1.0f), vec3_from_cartesian(1.0f, 0.0f, -1.0f),
+                      vec3_from_cartesian(0.3f, 0.8f, -0.5f), vec3_from_cartesian(-0.6f, -0.2f, 0.9f) };
+    int ok = 1;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            vec3f_t from = vec3f_from_vec3(dirs[i]), to = vec3f_from_vec3(dirs[j]);
+            for (int k = 0; k <= 8; k++) {
+                float t = k / 8.0f;
+                if (i > 1 || j > 1) t = (float)(k & 1);
+                mat4_t got = apply_quaternion_rotation(dirs[i], dirs[j], t);
+                mat4_t expected = ref_look_at(from, to, t);
+                ok = ok && mat4_nearly_equal(&got, &expected);
+            }
+        }
+    }
+    check(ok, "apply_quaternion_rotation matches the old look-at matrix");
+}
+
+static int affine_matches_mat4(affine_t a, const mat4_t* m) {
+    mat4_t expanded = affine_to_mat4(a);
+    return mat4_nearly_equal(&expanded, m);
+}
+
+static void test_affine(void) {
+    affine_t ta = affine_translate(1.0f, -2.0f, 3.0f);
+    affine_t ra = affine_rotate_xyz(0.3f, -1.2f, 2.1f);
+    affine_t sa = affine_scale(2.0f, 0.5f, 1.5f);
+    mat4_t tm = mat4_translate(1.0f, -2.0f, 3.0f);
+    mat4_t rm = mat4_rotate_xyz(0.3f, -1.2f, 2.1f);
+    mat4_t sm = mat4_scale(2.0f, 0.5f, 1.5f);
+
+    check(affine_matches_mat4(ta, &tm) && affine_matches_mat4(ra, &rm) && affine_matches_mat4(sa, &sm),
+          "affine constructors match their mat4 counterparts");
+
+    affine_t trs = affine_multiply(ta, affine_multiply(ra, sa));
+    mat4_t rs = ref_multiply(&rm, &sm);
+    mat4_t trs_m = ref_multiply(&tm, &rs);
+    check(affine_matches_mat4(trs, &trs_m), "affine_multiply matches mat4 composition");
+
+    affine_t aliased = ta;
+    affine_multiply_into(&aliased, &aliased, &ra);
+    mat4_t tr_m = ref_multiply(&tm, &rm);
+    check(affine_matches_mat4(aliased, &tr_m), "affine_multiply_into with aliased output");
+
+    quat_t q = quat_from_euler_xyz(0.3f, -1.2f, 2.1f);
+    check(affine_matches_mat4(affine_from_quat(q, vec3f_make(1.0f, -2.0f, 3.0f)), &tr_m),
+          "affine_from_quat matches translate * quat_to_mat4");
+
+    mat4_t proj = mat4_frustum(-2.5f, 2.5f, -2.0f, 2.0f, 3.0f, 30.0f);
+    mat4_t expected = ref_multiply(&proj, &trs_m);
+    mat4_t got;
+    mat4_multiply_affine(&got, &proj, &trs);
+    check(mat4_nearly_equal(&expected, &got), "mat4_multiply_affine matches full projection multiply");
+
+    affine_t inv;
+    int inv_ok = affine_inverse(&inv, &trs) == 0;
+    affine_t should_be_identity = affine_multiply(trs, inv);
+    mat4_t identity = mat4_identity();
+    inv_ok = inv_ok && affine_matches_mat4(should_be_identity, &identity);
+    affine_t rigid = affine_multiply(ta, ra);
+    should_be_identity = affine_multiply(affine_inverse_rigid(rigid), rigid);
+    inv_ok = inv_ok && affine_matches_mat4(should_be_identity, &identity);
+    affine_t flat = affine_scale(1.0f, 0.0f, 1.0f);
+    inv_ok = inv_ok && affine_inverse(&inv, &flat) == -1;
+    check(inv_ok, "affine_inverse/affine_inverse_rigid invert, singular input is rejected");
+
+    vec3f_t in[9], out[9];
+    for (int i = 0; i < 9; i++) in[i] = vec3f_make(i * 0.5f - 2.0f, sinf((float)i), cosf(i * 0.3f));
+    affine_transform_points(&trs, in, out, 9);
+    int points_ok = 1;
+    for (int i = 0; i < 9; i++) {
+        vec4_t r = mat4_mul_vec4(&trs_m, (vec4_t){ in[i].x, in[i].y, in[i].z, 1.0f });
+        vec3f_t p = affine_transform_point(&trs, in[i]);
+        vec3f_t d = affine_transform_dir(&trs, in[i]);
+        vec4_t rd = mat4_mul_vec4(&trs_m, (vec4_t){ in[i].x, in[i].y, in[i].z, 0.0f });
+        if (!nearly_equal(out[i].x, r.x) || !nearly_equal(out[i].y, r.y) || !nearly_equal(out[i].z, r.z)) points_ok = 0;
+        if (!nearly_equal(p.x, r.x) || !nearly_equal(p.y, r.y) || !nearly_equal(p.z, r.z)) points_ok = 0;
+        if (!nearly_equal(d.x, rd.x) || !nearly_equal(d.y, rd.y) || !nearly_equal(d.z, rd.z)) points_ok = 0;
+    }
+    check(points_ok, "affine point/direction transforms match mat4_mul_vec4");
+}
+
+static void test_batch_lighting(void) {
+    // Ring of vertices plus one at the origin (degenerate normal); 23 edges
+    // exercises the SIMD body and the scalar tail
+    vec3_t verts[13];
+    int edges[23][2];
+    for (int i = 0; i < 12; i++) {
+        float a = i * 0.5236f;
+        verts[i] = vec3_from_cartesian(cosf(a) * 1.5f, sinf(a * 2.0f) * 0.7f, sinf(a) * 1.5f);
+    }
+    verts[12] = vec3_from_cartesian(0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < 12; i++) {
+        edges[i][0] = i;
+        edges[i][1] = (i + 1) % 12;
+    }
+    for (int i = 0; i < 11; i++) {
+        edges[12 + i][0] = i;
+        edges[12 + i][1] = (i % 2) ? 12 : (i + 6) % 12;
+    }
+
+    light_t lights[3];
+    vec3_t white = vec3_from_cartesian(1.0f, 1.0f, 1.0f);
+    lights[0] = light_create(vec3_from_cartesian(0.0f, 0.0f, -10.0f), white, 1.0f);
+    lights[1] = light_create(vec3_from_cartesian(5.0f, 5.0f, -5.0f), white, 0.5f);
+    lights[2] = light_create(vec3_from_cartesian(-5.0f, 2.0f, 8.0f), white, 0.25f);
+
+    mesh_t* mesh = mesh_from_vec3(verts, 13, edges, 23);
+    float batch[23];
+    calculate_edges_lighting(mesh, lights, 3, batch);
+
+    int ok = 1;
+    for (int i = 0; i < 23; i++) {
+        float expected = calculate_edge_lighting(verts[edges[i][0]], verts[edges[i][1]], lights, 3);
+        if (!nearly_equal(batch[i], expected)) ok = 0;
+    }
+    check(ok, "calculate_edges_lighting matches per-edge calculate_edge_lighting");
+
+    // Model-space lighting equals world-space lighting with the normals carried along
+    affine_t model = affine_multiply(affine_translate(2.0f, -1.0f, 4.0f), affine_rotate_xyz(0.7f, -0.3f, 1.9f));
+    calculate_edges_lighting_model(mesh, &model, lights, 3, batch);
+    ok = 1;
+    for (int i = 0; i < 23; i++) {
+        vec3f_t mid = vec3f_make(mesh->mid_x[i], mesh->mid_y[i], mesh->mid_z[i]);
+        vec3f_t world_mid = affine_transform_point(&model, mid);
+        vec3f_t world_normal = affine_transform_dir(&model, vec3f_normalize(mid));
+        float expected = 0.0f;
+        for (int l = 0; l < 3; l++) {
+            vec3f_t to_light = vec3f_normalize(vec3f_sub(vec3f_from_vec3(lights[l].position), world_mid));
+            float dot = vec3f_dot(world_normal, to_light);
+            if (dot > 0.0f) expected += dot * lights[l].intensity * 1.5f;
+        }
+        if (expected > 1.0f) expected = 1.0f;
+        if (fabsf(batch[i] - expected) > 1e-4f) ok = 0;
+    }
+    check(ok, "calculate_edges_lighting_model matches world-space lighting of the placed mesh");
+
+    // Ranged and disabled lights: batch culling must agree with the per-edge path
+    light_t mixed[5];
+    mixed[0] = light_create_ranged(vec3_from_cartesian(1.5f, 0.0f, 0.5f), white, 0.8f, 1.2f);
+    mixed[1] = light_create_ranged(vec3_from_cartesian(0.0f, 2.0f, 0.0f), white, 0.6f, 2.5f);
+    mixed[2] = light_create_ranged(vec3_from_cartesian(40.0f, 0.0f, 0.0f), white, 1.0f, 5.0f);
+    mixed[3] = light_create(vec3_from_cartesian(0.0f, 0.0f, -10.0f), white, 0.0f);
+    mixed[4] = light_create(vec3_from_cartesian(-3.0f, -1.0f, 2.0f), white, 0.3f);
+    calculate_edges_lighting(mesh, mixed, 5, batch);
+    ok = 1;
+    for (int i = 0; i < 23; i++) {
+        float expected = calculate_edge_lighting(verts[edges[i][0]], verts[edges[i][1]], mixed, 5);
+        if (!nearly_equal(batch[i], expected)) ok = 0;
+    }
+    check(ok, "calculate_edges_lighting honours light range and skips disabled lights");
+
+    light_t kept[5];
+    int kept_count = lights_cull(mixed, 5, mesh->bound_center, mesh->bound_radius, kept);
+    check(kept_count == 3 && kept[0].intensity == 0.8f && kept[2].intensity == 0.3f,
+          "lights_cull drops zero-intensity and out-of-range lights");
+
+    // A negative light darkens what the others light, in both paths
+    light_t dimmed[2] = { lights[0], light_create(vec3_from_cartesian(0.0f, 0.0f, -10.0f), white, -0.25f) };
+    calculate_edges_lighting(mesh, dimmed, 2, batch);
+    ok = lights_cull(dimmed, 2, mesh->bound_center, mesh->bound_radius, kept) == 2;
+    int darker = 0;
+    for (int i = 0; i < 23; i++) {
+        float expected = calculate_edge_lighting(verts[edges[i][0]], verts[edges[i][1]], dimmed, 2);
+        float lit = calculate_edge_lighting(verts[edges[i][0]], verts[edges[i][1]], lights, 1);
+        if (!nearly_equal(batch[i], expected) || expected > lit) ok = 0;
+        darker += expected < lit;
+    }
+    check(ok && darker > 0, "negative-intensity lights darken instead of being culled");
+    mesh_destroy(mesh);
+}
+
+// Reference thick line: exp() per perpendicular sample, as draw_line_f did before its falloff table
+static void ref_draw_line(canvas_t* canvas, float x0, float y0, float x1, float y1, float thickness) {
+    float dx = x1 - x0, dy = y1 - y0;
+    int steps = (int)(fmax(fabs(dx), fabs(dy)) * 2);
+    if (steps == 0) {
+        set_pixel_f(canvas, x0, y0, 1.0f);
+        return;
+    }
+    float x_step = dx / steps, y_step = dy / steps;
+    float length = sqrt(dx * dx + dy * dy);
+    float perp_x = -dy / length * thickness / 2.0f;
+    float perp_y = dx / length * thickness / 2.0f;
+    for (int i = 0; i <= steps; i++) {
+        float x = x0 + i * x_step;
+        float y = y0 + i * y_step;
+        int thickness_steps = (int)(thickness * 2) + 1;
+        for (int t = 0; t < thickness_steps; t++) {
+            float t_ratio = (thickness_steps == 1) ? 0 : (float)t / (thickness_steps - 1) - 0.5f;
+            float falloff = exp(-2.0f * t_ratio * t_ratio);
+            set_pixel_f(canvas, x + perp_x * t_ratio * 2.0f, y + perp_y * t_ratio * 2.0f, falloff);
+        }
+    }
+}
+
+static void test_line_falloff(void) {
+    canvas_t* expected = canvas_create(128, 128);
+    canvas_t* got = canvas_create(128, 128);
+    // Thin, fractional, table-edge and beyond-table thicknesses
+    float thickness[] = { 0.3f, 0.5f, 1.37f, 2.9f, 3.5f, 31.4f, 40.0f };
+    for (int k = 0; k < 7; k++) {
+        float a = k * 0.9f;
+        ref_draw_line(expected, 64.0f, 64.0f, 64.0f + cosf(a) * 50.0f, 64.0f + sinf(a) * 50.0f, thickness[k]);
+        draw_line_f(got, 64.0f, 64.0f, 64.0f + cosf(a) * 50.0f, 64.0f + sinf(a) * 50.0f, thickness[k]);
+    }
+    int ok = 1;
+    for (int y = 0; y < 128; y++) {
+        for (int x = 0; x < 128; x++) {
+            if (expected->pixels[y][x] != got->pixels[y][x]) ok = 0;
+        }
+    }
+    check(ok, "draw_line_f falloff table matches per-sample exp() exactly");
+    canvas_destroy(expected);
+    canvas_destroy(got);
+}
+
+static void test_guard_band(void) {
+    // Lines leaving every edge, thin enough for the unchecked loops and too thick for them
+    canvas_t* expected = canvas_create(97, 61);
+    canvas_t* rows = canvas_create(97, 61);
+    canvas_t* blocked = canvas_create_blocked(97, 61);
+    float thickness[] = { 0.5f, 1.5f, CANVAS_GUARD - 6.0f, CANVAS_GUARD - 5.5f, 14.0f };
+    for (int pass = 0; pass < 2; pass++) {
+        // The second pass starts from cleared canvases: nothing may survive in the border
+        canvas_clear(expected);
+        canvas_clear(rows);
+        canvas_clear(blocked);
+        for (int k = 0; k < 36; k++) {
+            float a = k * 0.1745f + pass * 0.05f;
+            float x1 = 48.3f + cosf(a) * 75.0f, y1 = 30.6f + sinf(a) * 50.0f;
+            ref_draw_line(expected, 48.3f, 30.6f, x1, y1, thickness[k % 5]);
+            draw_line_f(rows, 48.3f, 30.6f, x1, y1, thickness[k % 5]);
+            draw_line_f(blocked, 48.3f, 30.6f, x1, y1, thickness[k % 5]);
+        }
+        draw_line_f(rows, -30.0f, -20.0f, 130.0f, -25.0f, 3.0f);
+        draw_line_f(blocked, -30.0f, -20.0f, 130.0f, -25.0f, 3.0f);
+    }
+
+    int ok = 1;
+    float scratch[97];
+    for (int y = 0; y < 61; y++) {
+        ok = ok && memcmp(rows->pixels[y], expected->pixels[y], sizeof(scratch)) == 0;
+        ok = ok && memcmp(canvas_row(blocked, y, scratch), expected->pixels[y], sizeof(scratch)) == 0;
+    }
+    check(ok, "lines clipped into the guard band match bounds-checked splats");
+
+    // Endpoints the clipping cannot bound must not reach the unchecked loops;
+    // a sparse canvas always takes the checked path
+    canvas_t* sparse = canvas_create_sparse(97, 61);
+    float bad[] = { NAN, INFINITY, -INFINITY, 3.0e7f };
+    canvas_clear(rows);
+    canvas_clear(blocked);
+    for (int k = 0; k < 16; k++) {
+        float p[4] = { 10.0f, 12.0f, 80.0f, 50.0f };
+        p[k % 4] = bad[k / 4];
+        draw_line_f(rows, p[0], p[1], p[2], p[3], 1.5f);
+        draw_line_f(blocked, p[0], p[1], p[2], p[3], 1.5f);
+        draw_line_f(sparse, p[0], p[1], p[2], p[3], 1.5f);
+    }
+    ok = sparse != NULL;
+    float sparse_row[97];
+    for (int y = 0; ok && y < 61; y++) {
+        const float* want = canvas_row(sparse, y, sparse_row);
+        ok = memcmp(rows->pixels[y], want, sizeof(scratch)) == 0 &&
+             memcmp(canvas_row(blocked, y, scratch), want, sizeof(scratch)) == 0;
+    }
+    check(ok, "NaN, infinite and far-off endpoints take the bounds-checked path");
+    canvas_destroy(sparse);
+    canvas_destroy(expected);
+    canvas_destroy(rows);
+    canvas_destroy(blocked);
+}
+
+static int files_equal(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    int equal = fa && fb;
+    while (equal) {
+        int ca = fgetc(fa), cb = fgetc(fb);
+        if (ca != cb) equal = 0;
+        if (ca == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return equal;
+}
+
+static void test_sparse_canvas(void) {
+    // Not a multiple of the tile size, with lines running off every edge
+    canvas_t* dense = canvas_create(300, 200);
+    canvas_t* sparse = canvas_create_sparse(300, 200);
+    for (int k = 0; k < 12; k++) {
+        float a = k * 0.55f;
+        float x1 = 150.0f + cosf(a) * 190.0f, y1 = 100.0f + sinf(a) * 130.0f;
+        draw_line_f(dense, 150.0f, 100.0f, x1, y1, 0.4f + k * 0.3f);
+        draw_line_f(sparse, 150.0f, 100.0f, x1, y1, 0.4f + k * 0.3f);
+    }
+    set_pixel_f(dense, 298.5f, 199.5f, 1.0f);
+    set_pixel_f(sparse, 298.5f, 199.5f, 1.0f);
+
+    int ok = 1;
+    float scratch[300];
+    for (int y = 0; y < 200; y++) {
+        const float* row = canvas_row(sparse, y, scratch);
+        for (int x = 0; x < 300; x++) {
+            if (row[x] != dense->pixels[y][x] || canvas_get_pixel(sparse, x, y) != dense->pixels[y][x]) ok = 0;
+        }
+    }
+    check(ok, "sparse canvas draws the same pixels as a dense one");
+    ok = canvas_save_pgm(dense, "test_dense.pgm") == 0 && canvas_save_pgm(sparse, "test_sparse.pgm") == 0 &&
+         files_equal("test_dense.pgm", "test_sparse.pgm");
+    check(ok, "sparse canvas saves a byte-identical PGM");
+
+    FILE* file = fopen("test_sparse.pgm", "wb");
+    ok = file && canvas_tile_count(sparse) > 0 && canvas_write_pgm(sparse, file, 1) == 0;
+    if (file) fclose(file);
+    ok = ok && canvas_tile_count(sparse) == 0 && files_equal("test_dense.pgm", "test_sparse.pgm");
+    check(ok, "streaming PGM writer releases each band once written");
+    remove("test_dense.pgm");
+    remove("test_sparse.pgm");
+    canvas_destroy(dense);
+    canvas_destroy(sparse);
+
+    // A 32k x 32k poster only allocates the tiles its lines cross
+    canvas_t* poster = canvas_create_sparse(32768, 32768);
+    ok = poster != NULL;
+    if (poster) {
+        draw_line_f(poster, 100.0f, 100.0f, 32600.0f, 32000.0f, 2.0f);
+        draw_line_f(poster, 32700.0f, 50.0f, 20.0f, 50.0f, 1.0f);
+        int tiles = canvas_tile_count(poster);  // of 512 * 512
+        ok = tiles > 0 && tiles < 4 * 512 && canvas_get_pixel(poster, 16000, 50) > 0.0f &&
+             canvas_get_pixel(poster, 5, 30000) == 0.0f;
+        canvas_clear(poster);
+        ok = ok && canvas_tile_count(poster) == 0;
+    }
+    check(ok, "sparse poster canvas allocates tiles only along its lines");
+    canvas_destroy(poster);
+}
+
+static void test_blocked_canvas(void) {
+    // Not a multiple of the block size; lines cross block edges at every angle and leave the canvas
+    canvas_t* rows = canvas_create(203, 117);
+    canvas_t* blocked = canvas_create_blocked(203, 117);
+    for (int k = 0; k < 40; k++) {
+        float a = k * 0.157f;
+        float x1 = 101.0f + cosf(a) * 140.0f, y1 = 58.5f + sinf(a) * 90.0f;
+        draw_line_f(rows, 101.0f, 58.5f, x1, y1, 0.3f + (k % 5) * 0.8f);
+        draw_line_f(blocked, 101.0f, 58.5f, x1, y1, 0.3f + (k % 5) * 0.8f);
+    }
+    set_pixel_f(rows, 202.5f, 116.25f, 0.75f);
+    set_pixel_f(blocked, 202.5f, 116.25f, 0.75f);
+
+    int ok = 1;
+    float scratch[203];
+    for (int y = 0; y < 117; y++) {
+        ok = ok && memcmp(canvas_row(blocked, y, scratch), rows->pixels[y], sizeof(scratch)) == 0;
+        for (int x = 0; x < 203; x += 7) ok = ok && canvas_get_pixel(blocked, x, y) == rows->pixels[y][x];
+    }
+    check(ok, "blocked canvas draws the same pixels as a row-major one");
+    ok = canvas_save_pgm(rows, "test_rows.pgm") == 0 && canvas_save_pgm(blocked, "test_blocked.pgm") == 0 &&
+         files_equal("test_rows.pgm", "test_blocked.pgm");
+    check(ok, "blocked canvas saves a byte-identical PGM");
+    canvas_clear(blocked);
+    ok = canvas_get_pixel(blocked, 101, 58) == 0.0f;
+    check(ok, "canvas_clear empties a blocked canvas");
+    remove("test_rows.pgm");
+    remove("test_blocked.pgm");
+    canvas_destroy(rows);
+    canvas_destroy(blocked);
+}
+
+// Strip callback: compares each band with the same rows of a full render
+typedef struct {
+    const canvas_t* full;
+    int next_row;
+    int matches;
+} strip_check_t;
+
+static int check_strip(const canvas_t* strip, int rows, void* user) {
+    strip_check_t* c = user;
+    if (strip->origin_y != c->next_row) c->matches = 0;
+    for (int y = 0; y < rows && c->matches; y++) {
+        if (memcmp(strip->pixels[y], c->full->pixels[strip->origin_y + y], strip->width * sizeof(float)) != 0) {
+            c->matches = 0;
+        }
+    }
+    c->next_row += rows;
+    return 0;
+}
+
+static void test_strip_render(void) {
+    // A ball overlapping the viewport edge, drawn thick enough to cross many bands
+    const geometry_t* ball = geometry_truncated_icosphere_cached(1);
+    mat4_t proj = mat4_frustum(-2.5f, 2.5f, -2.0f, 2.0f, 3.0f, 30.0f);
+    mat4_t model = mat4_multiply(mat4_translate(1.2f, -0.8f, 4.0f), mat4_rotate_xyz(0.7f, 1.9f, 0.4f));
+    mat4_t mvp = mat4_multiply(proj, mat4_multiply(mat4_translate(0.0f, 0.0f, -10.0f), model));
+    const int width = 257, height = 301;
+
+    canvas_t* full = canvas_create(width, height);
+    int ok = ball && full;
+    if (ok) render_wireframe(full, ball->verts, ball->vert_count, ball->edges, ball->edge_count, mvp);
+    int bands[] = { 1, 7, 64, 300, 301, 1000 };
+    for (int k = 0; k < 6 && ok; k++) {
+        strip_check_t c = { full, 0, 1 };
+        ok = render_wireframe_strips(width, height, bands[k], ball->verts, ball->vert_count, ball->edges,
+                                     ball->edge_count, mvp, check_strip, &c) == 0 &&
+             c.matches && c.next_row == height;
+    }
+    check(ok, "render_wireframe_strips matches a full render for every band height");
+
+    ok = ok && canvas_save_pgm(full, "test_full.pgm") == 0 &&
+         render_wireframe_pgm("test_strips.pgm", width, height, 32, ball->verts, ball->vert_count, ball->edges,
+                              ball->edge_count, mvp) == 0 &&
+         files_equal("test_full.pgm", "test_strips.pgm");
+    check(ok, "render_wireframe_pgm writes the same file as a full render");
+
+    // A mapped mesh file draws straight from its SoA arrays, pixel for pixel
+    mesh_t* saved = ok ? mesh_from_vec3(ball->verts, ball->vert_count, ball->edges, ball->edge_count) : NULL;
+    mesh_t* loaded = saved && mesh_save(saved, "test_render.t3m") == 0 ? mesh_load("test_render.t3m") : NULL;
+    canvas_t* from_mesh = canvas_create(width, height);
+    ok = loaded && from_mesh;
+    if (ok) render_wireframe_mesh(from_mesh, loaded, mvp);
+    for (int y = 0; y < height && ok; y++) {
+        ok = memcmp(from_mesh->pixels[y], full->pixels[y], width * sizeof(float)) == 0;
+    }
+    strip_check_t c = { full, 0, 1 };
+    ok = ok && render_wireframe_mesh_strips(width, height, 16, loaded, mvp, check_strip, &c) == 0 &&
+         c.matches && c.next_row == height;
+    check(ok, "render_wireframe_mesh and its strips match render_wireframe for a loaded mesh");
+    remove("test_full.pgm");
+    remove("test_strips.pgm");
+    remove("test_render.t3m");
+    mesh_destroy(saved);
+    mesh_destroy(loaded);
+    canvas_destroy(from_mesh);
+    canvas_destroy(full);
+    geometry_cache_clear();
+}
+
+static int affine_nearly_equal(const affine_t* a, const affine_t* b) {
+    for (int i = 0; i < 12; i++) {
+        if (!nearly_equal(a->m[i], b->m[i])) return 0;
+    }
+    return 1;
+}
+
+static void test_animation_tracks(void) {
+    animation_path_t path = path_create(vec3_from_cartesian(-4.0f, 0.0f, 0.0f), vec3_from_cartesian(-2.0f, 3.0f, 2.0f),
+                                        vec3_from_cartesian(2.0f, -2.0f, 1.0f), vec3_from_cartesian(4.0f, 0.0f, 0.0f), 5.0f);
+    vec3f_t spin = vec3f_make(2.0f, 1.5f, 1.0f);
+    animation_track_t* track = track_bake(&path, spin, 30.0f, 300);
+    if (!track) {
+        check(0, "track_bake allocates");
+        return;
+    }
+
+    // Baked frames reproduce path_evaluate and translate * affine_rotate_xyz
+    int frames_ok = 1;
+    for (int f = 0; f < 300; f += 7) {
+        float time = f * (1.0f / 30.0f);
+        vec3_t p = path_evaluate(&path, time);
+        affine_t expected = affine_multiply(affine_translate(p.x, p.y, p.z),
+                                            affine_rotate_xyz(spin.x * time, spin.y * time, spin.z * time));
+        affine_t got = track_frame(track, f);
+        if (!affine_nearly_equal(&expected, &got)) frames_ok = 0;
+        if (got.m[3] != p.x || got.m[7] != p.y || got.m[11] != p.z) frames_ok = 0;
+    }
+    check(frames_ok, "track_frame matches path_evaluate and affine_rotate_xyz");
+
+    // Sampling on a frame returns that frame; between frames it blends and stays rigid
+    affine_t on_frame = track_sample(track, 42.0f / 30.0f);
+    affine_t frame_42 = track_frame(track, 42);
+    affine_t mid = track_sample(track, 42.5f / 30.0f);
+    affine_t frame_43 = track_frame(track, 43);
+    int sample_ok = affine_nearly_equal(&on_frame, &frame_42);
+    sample_ok = sample_ok && nearly_equal(mid.m[3], 0.5f * (frame_42.m[3] + frame_43.m[3]));
+    vec3f_t axis = affine_transform_dir(&mid, vec3f_make(1.0f, 0.0f, 0.0f));
+    sample_ok = sample_ok && nearly_equal(vec3f_length(axis), 1.0f);
+    affine_t before = track_sample(track, -1.0f), first = track_frame(track, 0);
+    affine_t after = track_sample(track, 100.0f), last = track_frame(track, 299);
+    sample_ok = sample_ok && affine_nearly_equal(&before, &first) && affine_nearly_equal(&after, &last);
+    check(sample_ok, "track_sample hits baked frames, blends between them and clamps");
+    track_destroy(track);
+
+    animation_track_t* still = track_bake(NULL, vec3f_make(0.0f, 0.0f, 0.0f), 24.0f, 4);
+    affine_t identity = affine_identity();
+    affine_t got = still ? track_frame(still, 3) : identity;
+    check(still && affine_nearly_equal(&got, &identity) && !track_bake(NULL, spin, 0.0f, 4),
+          "track_bake without a path stays at the origin, rejects fps <= 0");
+    track_destroy(still);
+}
+
+// Reference: linear scan for the segment, then lerp one channel
+static float ref_timeline_channel(const animation_keyframe_t* keys, int n, float time, int channel) {
+    float v[64];
+    for (int i = 0; i < n; i++) {
+        vec3_t p = keys[i].position, rt = keys[i].rotation, sc = keys[i].scale;
+        float all[9] = { p.x, p.y, p.z, rt.x, rt.y, rt.z, sc.x, sc.y, sc.z };
+        v[i] = all[channel];
+    }
+    if (time <= keys[0].time) return v[0];
+    if (time >= keys[n - 1].time) return v[n - 1];
+    int i = 0;
+    while (keys[i + 1].time <= time && i + 1 < n - 1) i++;
+    float u = (time - keys[i].time) / (keys[i + 1].time - keys[i].time);
+    return v[i] + (v[i + 1] - v[i]) * u;
+}
+
+static int timeline_matches(animation_timeline_t* timeline, const animation_keyframe_t* keys, int n, float time) {
+    vec3f_t p, rt, sc;
+    timeline_evaluate(timeline, time, &p, &rt, &sc);
+    float got[9] = { p.x, p.y, p.z, rt.x, rt.y, rt.z, sc.x, sc.y, sc.z };
+    for (int c = 0; c < 9; c++) {
+        if (!nearly_equal(got[c], ref_timeline_channel(keys, n, time, c))) return 0;
+    }
+    return 1;
+}
+
+static void test_timelines(void) {
+    animation_keyframe_t keys[12];
+    for (int i = 0; i < 12; i++) {
+        float t = i * 0.5f + (i % 3) * 0.1f;
+        keys[i] = keyframe_create(vec3_from_cartesian(sinf((float)i) * 3.0f, i * 0.25f, -1.0f * i),
+                                  vec3_from_cartesian(i * 0.7f, -0.2f * i, 0.0f),
+                                  vec3_from_cartesian(1.0f + i * 0.1f, 1.0f, 2.0f - i * 0.1f), t);
+    }
+    animation_timeline_t* timeline = timeline_create(keys, 12);
+    if (!timeline) {
+        check(0, "timeline_create allocates");
+        return;
+    }
+
+    // Forward playback (cursor walk), then random seeks in both directions
+    int forward_ok = 1;
+    for (int f = -5; f < 200; f++) {
+        if (!timeline_matches(timeline, keys, 12, f * (1.0f / 30.0f))) forward_ok = 0;
+    }
+    check(forward_ok, "timeline_evaluate matches linear search during forward playback and clamps");
+
+    int seek_ok = 1;
+    for (int k = 0; k < 200; k++) {
+        float time = fmodf(k * 2.713f, 6.5f) - 0.3f;
+        if (!timeline_matches(timeline, keys, 12, time)) seek_ok = 0;
+    }
+    for (int i = 0; i < 12; i++) {
+        if (!timeline_matches(timeline, keys, 12, keys[i].time)) seek_ok = 0;
+    }
+    check(seek_ok, "timeline_evaluate matches linear search for random seeks and exact key times");
+
+    affine_t models[2];
+    animation_timeline_t* both[2] = { timeline, timeline };
+    timelines_evaluate(both, 2, 1.3f, models);
+    vec3f_t p, rt, sc;
+    timeline_evaluate(timeline, 1.3f, &p, &rt, &sc);
+    affine_t expected = affine_multiply(affine_translate(p.x, p.y, p.z),
+                                        affine_multiply(affine_rotate_xyz(rt.x, rt.y, rt.z), affine_scale(sc.x, sc.y, sc.z)));
+    check(affine_nearly_equal(&models[0], &expected) && affine_nearly_equal(&models[1], &expected),
+          "timelines_evaluate builds translate * rotate_xyz * scale");
+    timeline_destroy(timeline);
+
+    // Coincident keys step; unsorted keys are rejected; a single key is constant
+    animation_keyframe_t step[3] = { keys[0], keys[1], keys[2] };
+    step[1].time = step[2].time = 1.0f;
+    animation_timeline_t* stepped = timeline_create(step, 3);
+    animation_keyframe_t unsorted[2] = { keys[3], keys[1] };
+    animation_timeline_t* single = timeline_create(keys + 5, 1);
+    int edge_ok = stepped && single && !timeline_create(unsorted, 2) && !timeline_create(keys, 0);
+    if (edge_ok) {
+        timeline_evaluate(stepped, 1.0f, &p, NULL, NULL);
+        edge_ok = p.x == step[2].position.x;
+        timeline_evaluate(single, 42.0f, &p, NULL, NULL);
+        edge_ok = edge_ok && p.y == keys[5].position.y;
+    }
+    check(edge_ok, "timeline handles coincident keys, single keys and rejects unsorted input");
+    timeline_destroy(stepped);
+    timeline_destroy(single);
+}
+
+static float distance3(vec3_t a, vec3_t b) {
+    return sqrtf((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+}
+
+// Largest relative deviation of 100 consecutive steps from the mean step
+static float speed_deviation(vec3_t (*at)(const void*, float), const void* curve, float* travelled) {
+    float steps[100], mean = 0.0f, worst = 0.0f;
+    vec3_t prev = at(curve, 0.0f);
+    for (int i = 1; i <= 100; i++) {
+        vec3_t p = at(curve, i / 100.0f);
+        steps[i - 1] = distance3(prev, p);
+        mean += steps[i - 1] / 100.0f;
+        prev = p;
+    }
+    for (int i = 0; i < 100; i++) worst = fmaxf(worst, fabsf(steps[i] - mean) / mean);
+    *travelled = mean * 100.0f;
+    return worst;
+}
+
+static vec3_t path_at(const void* curve, float s) { return path_at_distance(curve, s); }
+static vec3_t spline_at(const void* curve, float s) { return spline_at_distance(curve, s); }
+
+static void test_arc_length(void) {
+    // The lighting test's soccer-ball path: raw Bezier speed varies by about 20%
+    animation_path_t path = path_create(vec3_from_cartesian(-4.0f, 0.0f, 0.0f), vec3_from_cartesian(-2.0f, 3.0f, 2.0f),
+                                        vec3_from_cartesian(2.0f, -2.0f, 1.0f), vec3_from_cartesian(4.0f, 0.0f, 0.0f), 2.0f);
+    vec3_t start = path_at_distance(&path, 0.0f), end = path_at_distance(&path, 1.0f);
+    float travelled;
+    float deviation = speed_deviation(path_at, &path, &travelled);
+    check(distance3(start, path.p0) < 1e-6f && distance3(end, path.p3) < 1e-6f &&
+          deviation < 0.05f && fabsf(travelled - path.length) < 1e-3f * path.length,
+          "path_at_distance moves at constant speed along the whole arc length");
+    vec3_t looped = path_evaluate_uniform(&path, 2.0f + 0.5f);
+    vec3_t half = path_at_distance(&path, 0.25f);
+    check(distance3(looped, half) < 1e-5f, "path_evaluate_uniform loops every duration");
+
+    // A hand-filled path has no table and gets one built per call
+    animation_path_t manual = { path.p0, path.p1, path.p2, path.p3, 2.0f, 0.0f, {0.0f}, 0 };
+    int manual_ok = 1;
+    for (int i = 0; i <= 8; i++) {
+        float s = i / 8.0f;
+        manual_ok &= distance3(path_at_distance(&manual, s), path_at_distance(&path, s)) < 1e-6f;
+    }
+    check(manual_ok, "path_at_distance builds the arc-length table for paths not made by path_create");
+
+    // Three joined segments of very different lengths
+    vec3_t points[10] = {
+        vec3_from_cartesian(0.0f, 0.0f, 0.0f), vec3_from_cartesian(0.3f, 0.3f, 0.0f), vec3_from_cartesian(0.6f, 0.7f, 0.0f),
+        vec3_from_cartesian(1.0f, 1.0f, 0.0f), vec3_from_cartesian(2.0f, 2.0f, 0.5f), vec3_from_cartesian(4.0f, 2.0f, 1.0f),
+        vec3_from_cartesian(5.0f, 1.0f, 0.5f), vec3_from_cartesian(5.5f, 0.5f, 0.0f), vec3_from_cartesian(6.5f, 0.2f, 0.0f),
+        vec3_from_cartesian(7.0f, 0.5f, 0.0f)
+    };
+    animation_spline_t* spline = spline_create(points, 3, 4.0f);
+    if (!spline) {
+        check(0, "spline_create allocates");
+        return;
+    }
+    deviation = speed_deviation(spline_at, spline, &travelled);
+    start = spline_at_distance(spline, 0.0f);
+    end = spline_at_distance(spline, 1.0f);
+    check(distance3(start, points[0]) < 1e-6f && distance3(end, points[9]) < 1e-6f &&
+          deviation < 0.05f && fabsf(travelled - spline->length) < 1e-3f * spline->length,
+          "spline_at_distance moves at constant speed across segment joints");
+    check(!spline_create(points, 0, 1.0f), "spline_create rejects empty splines");
+    spline_destroy(spline);
+}
+
+static int parse_sequence(sequence_t* seq, int argc, const char** argv) {
+    sequence_init(seq, 30, 15.0f, "frames");
+    return sequence_parse_args(seq, argc, (char**)argv);
+}
+
+static void test_sequence(void) {
+    sequence_t seq;
+    const char* full[] = { "prog" };
+    check(parse_sequence(&seq, 1, full) == 0 && seq.first_frame == 0 && seq.last_frame == 449 &&
+          sequence_frame_count(&seq) == 450, "sequence defaults cover the whole sequence");
+
+    // Shards of a range are disjoint and together cover it exactly once
+    int hits[450] = { 0 };
+    int shards_ok = 1;
+    for (int i = 0; i < 4; i++) {
+        char shard[16];
+        snprintf(shard, sizeof(shard), "%d/4", i);
+        const char* argv[] = { "prog", "--frames", "37:411", "--shard", shard };
+        if (parse_sequence(&seq, 5, argv) != 0) shards_ok = 0;
+        int count = 0;
+        for (int f = sequence_first(&seq); f <= seq.last_frame; f += seq.shard_count) {
+            hits[f]++;
+            count++;
+        }
+        if (count != sequence_frame_count(&seq)) shards_ok = 0;
+    }
+    for (int f = 0; f < 450; f++) {
+        if (hits[f] != (f >= 37 && f <= 411)) shards_ok = 0;
+    }
+    check(shards_ok, "sequence shards partition the frame range");
+
+    char path[SEQUENCE_PATH_MAX + 32];
+    const char* open_end[] = { "prog", "--fps", "24", "--duration", "2", "--frames", "40:", "--out", "out/a" };
+    int ok = parse_sequence(&seq, 9, open_end) == 0 && seq.total_frames == 48 &&
+             seq.first_frame == 40 && seq.last_frame == 47;
+    sequence_frame_path(&seq, 47, path, sizeof(path));
+    ok = ok && strcmp(path, "out/a/frame_0047.pgm") == 0;
+    ok = ok && nearly_equal(sequence_time(&seq, 12), 0.5f);
+    check(ok, "sequence parses fps/duration/open ranges and names frames by absolute index");
+
+    const char* bad_shard[] = { "prog", "--shard", "4/4" };
+    const char* bad_range[] = { "prog", "--frames", "500:600" };
+    const char* missing[] = { "prog", "--frames" };
+    const char* unknown[] = { "prog", "--bogus", "1" };
+    check(parse_sequence(&seq, 3, bad_shard) != 0 && parse_sequence(&seq, 3, bad_range) != 0 &&
+          parse_sequence(&seq, 2, missing) != 0 && parse_sequence(&seq, 3, unknown) != 0,
+          "sequence rejects bad shards, empty ranges, missing values and unknown flags");
+}
+
+static void test_sequence_resume(void) {
+    sequence_t seq;
+    const char* argv[] = { "prog", "--out", "test_resume_out", "--resume" };
+    parse_sequence(&seq, 4, argv);
+    canvas_t* canvas = canvas_create(16, 8);
+    draw_line_f(canvas, 1.0f, 1.0f, 14.0f, 6.0f, 1.5f);
+
+    // First run: no manifest yet, so nothing is trusted
+    int ok = sequence_prepare_output(&seq) == 0 && sequence_sync_manifest(&seq, "kernel test", 16, 8) == 0 &&
+             !seq.resume && sequence_save_frame(&seq, canvas, 3) == 0;
+
+    parse_sequence(&seq, 4, argv);
+    ok = ok && sequence_sync_manifest(&seq, "kernel test", 16, 8) == 0 && seq.resume;
+    ok = ok && sequence_frame_done(&seq, 3, 16, 8) && !sequence_frame_done(&seq, 4, 16, 8) &&
+         !sequence_frame_done(&seq, 3, 16, 9);
+    check(ok, "sequence resume trusts complete frames of the same scene only");
+
+    // Cut the frame short: it must be rendered again
+    char path[SEQUENCE_PATH_MAX + 32];
+    sequence_frame_path(&seq, 3, path, sizeof(path));
+    FILE* file = fopen(path, "rb");
+    char data[4096];
+    size_t size = file ? fread(data, 1, sizeof(data), file) : 0;
+    if (file) fclose(file);
+    file = fopen(path, "wb");
+    if (file) {
+        fwrite(data, 1, size - 5, file);
+        fclose(file);
+    }
+    ok = !sequence_frame_done(&seq, 3, 16, 8);
+
+    parse_sequence(&seq, 4, argv);
+    ok = ok && sequence_sync_manifest(&seq, "other scene", 16, 8) == 0 && !seq.resume;
+    check(ok, "sequence resume rejects truncated frames and a changed scene");
+
+    // Complete frames of one scene, then a run of another that stops after one
+    // frame: resuming the second scene must not pick up the first one's frames
+    char path5[SEQUENCE_PATH_MAX + 32];
+    sequence_frame_path(&seq, 5, path5, sizeof(path5));
+    ok = sequence_save_frame(&seq, canvas, 3) == 0 && sequence_save_frame(&seq, canvas, 5) == 0;
+    parse_sequence(&seq, 4, argv);
+    ok = ok && sequence_sync_manifest(&seq, "third scene", 16, 8) == 0 && sequence_save_frame(&seq, canvas, 3) == 0;
+    parse_sequence(&seq, 4, argv);
+    ok = ok && sequence_sync_manifest(&seq, "third scene", 16, 8) == 0 && seq.resume &&
+         sequence_frame_done(&seq, 3, 16, 8) && !sequence_frame_done(&seq, 5, 16, 8);
+    check(ok, "a scene change drops the old scene's frames before an interrupted run");
+
+    char manifest[SEQUENCE_PATH_MAX + 32];
+    snprintf(manifest, sizeof(manifest), "%s/manifest.txt", seq.output_dir);
+    remove(path);
+    remove(path5);
+    remove(manifest);
+    remove(seq.output_dir);
+    canvas_destroy(canvas);
+}
+
+static void test_frame_ring(void) {
+    const char* name = "/t3d_test_ring";
+    canvas_t* canvas = canvas_create(4, 3);
+    frame_ring_t* producer = frame_ring_create(name, 4, 3, 4);
+    if (!canvas || !producer) {
+        check(0, "frame_ring_create maps a shared-memory ring");
+        canvas_destroy(canvas);
+        frame_ring_close(producer);
+        return;
+    }
+
+    // Unwatched: the ring fills, then frames are dropped instead of blocking
+    int published = 0;
+    for (int frame = 0; frame < 6; frame++) {
+        canvas->pixels[1][2] = frame * 0.125f;
+        published += frame_ring_publish(producer, canvas, frame) == 0;
+    }
+    check(published == 4, "frame_ring_publish drops frames while no consumer is attached");
+
+    frame_ring_t* consumer = frame_ring_open(name);
+    int in_order = consumer != NULL && !frame_ring_open(name);
+    for (int expected = 0; consumer && expected < 4; expected++) {
+        int frame = -1;
+        const uint8_t* pixels = frame_ring_acquire(consumer, &frame);
+        in_order = in_order && pixels && frame == expected && pixels[1 * 4 + 2] == (uint8_t)(expected * 0.125f * 255);
+        frame_ring_release(consumer);
+    }
+    check(in_order && consumer && !frame_ring_acquire(consumer, NULL),
+          "frame_ring_acquire reads published frames in order from one consumer");
+
+    // A second producer (another shard) joins; pixels are clamped like the PGM range
+    frame_ring_t* shard = frame_ring_create(name, 4, 3, 4);
+    canvas->pixels[0][0] = 1.5f;
+    canvas->pixels[0][1] = -0.25f;
+    int joined = shard && !frame_ring_create(name, 8, 3, 4) && frame_ring_publish(shard, canvas, 40) == 0;
+    int frame = -1;
+    const uint8_t* pixels = consumer ? frame_ring_acquire(consumer, &frame) : NULL;
+    joined = joined && pixels && frame == 40 && pixels[0] == 255 && pixels[1] == 0;
+    if (consumer) frame_ring_release(consumer);
+    check(joined, "frame_ring_create lets shards share a ring and rejects other frame sizes");
+
+    frame_ring_close(shard);
+    int open_while_producing = consumer && !frame_ring_finished(consumer);
+    frame_ring_close(producer);
+    check(open_while_producing && consumer && frame_ring_finished(consumer),
+          "frame_ring_finished reports the ring drained after the last producer closes");
+    frame_ring_close(consumer);
+
+    sequence_t seq;
+    const char* argv[] = { "prog", "--ring", "preview" };
+    check(parse_sequence(&seq, 3, argv) == 0 && strcmp(seq.ring_name, "/preview") == 0 && !seq.ring,
+          "sequence parses --ring into a shared-memory name");
+    canvas_destroy(canvas);
+}
+
+#ifdef TEST_FORK
+// Run a producer in a child process that exits without closing; 1 if it ran.
+// With claim set it also claims a slot after publishing, and never fills it.
+// claim 1: dies after recording its pid in a claimed slot; claim 2: dies
+// before that, after which frame 8 lands in the next slot
+static int crashed_producer(const char* name, const canvas_t* canvas, int claim) {
+    pid_t child = fork();
+    if (child == 0) {
+        frame_ring_t* ring = frame_ring_create(name, canvas->width, canvas->height, 4);
+        if (ring && claim) {
+            frame_ring_publish(ring, canvas, 7);
+            frame_ring_header_t* h = ring->header;
+            uint64_t pos = h->head++;
+            frame_ring_slot_t* slot = (frame_ring_slot_t*)((uint8_t*)h + sizeof(*h) +
+                                                           (pos & (h->slot_count - 1)) * h->slot_stride);
+            if (claim == 1) slot->writer = (uint32_t)getpid();
+            if (claim == 2) frame_ring_publish(ring, canvas, 8);
+        }
+        _exit(ring ? 0 : 1);
+    }
+    int status = 1;
+    return child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void test_frame_ring_crash(void) {
+    const char* name = "/t3d_test_ring_crash";
+    canvas_t* canvas = canvas_create(4, 3);
+
+    // The consumer reads what the dead producer published, skips the slot it
+    // claimed, and sees the ring finish instead of waiting for it forever
+    int ok = canvas && crashed_producer(name, canvas, 1);
+    frame_ring_t* consumer = ok ? frame_ring_open(name) : NULL;
+    int frame = -1;
+    ok = consumer && frame_ring_acquire(consumer, &frame) && frame == 7;
+    if (consumer) frame_ring_release(consumer);
+    int polls = 0;
+    while (consumer && !frame_ring_finished(consumer) && polls < 10) polls++;
+    ok = ok && polls < 10 && consumer->reading == 2;
+    frame_ring_close(consumer);
+    check(ok, "frame_ring_finished gets past a producer that died mid-frame");
+
+    // A slot claimed with no writer recorded yet is skipped once the ring
+    // closes, and the frame published after it is still delivered
+    ok = crashed_producer(name, canvas, 2);
+    consumer = ok ? frame_ring_open(name) : NULL;
+    int frames[2] = { -1, -1 };
+    int got = 0;
+    polls = 0;
+    while (consumer && got < 2 && polls++ < 10) {
+        if (frame_ring_acquire(consumer, &frames[got])) {
+            frame_ring_release(consumer);
+            got++;
+        } else if (frame_ring_finished(consumer)) {
+            break;
+        }
+    }
+    ok = consumer && got == 2 && frames[0] == 7 && frames[1] == 8 && frame_ring_finished(consumer) &&
+         consumer->reading == 3;
+    frame_ring_close(consumer);
+    check(ok, "frame_ring_finished skips a slot whose producer died before claiming it fully");
+
+    // Later runs under the name replace a ring whose producers all died
+    ok = crashed_producer(name, canvas, 0);
+    frame_ring_t* producer = frame_ring_create(name, 4, 3, 4);
+    ok = ok && producer && producer->header->producers == 1 && !producer->header->closed;
+    frame_ring_close(producer);
+    frame_ring_t* gone = frame_ring_open(name);
+    check(ok && !gone, "frame_ring_create replaces a ring left by dead producers");
+    frame_ring_close(gone);
+    canvas_destroy(canvas);
+}
+#endif
+
+static int arrays_equal(const float* a, const float* b, int count) {
+    return count == 0 || memcmp(a, b, count * sizeof(float)) == 0;
+}
+
+static void test_mesh_file(void) {
+    vec3_t verts[7];
+    int edges[9][2];
+    for (int i = 0; i < 7; i++) verts[i] = vec3_from_cartesian(i * 0.5f - 1.0f, sinf((float)i), cosf(i * 0.7f));
+    for (int i = 0; i < 9; i++) {
+        edges[i][0] = i % 7;
+        edges[i][1] = (i * 3 + 1) % 7;
+    }
+    mesh_t* mesh = mesh_from_vec3(verts, 7, edges, 9);
+    const char* filename = "test_mesh_file.t3m";
+    mesh_t* loaded = mesh && mesh_save(mesh, filename) == 0 ? mesh_load(filename) : NULL;
+
+    int ok = loaded && loaded->vert_count == 7 && loaded->edge_count == 9 &&
+             arrays_equal(mesh->px, loaded->px, 7) && arrays_equal(mesh->py, loaded->py, 7) &&
+             arrays_equal(mesh->pz, loaded->pz, 7) && memcmp(mesh->edges, loaded->edges, sizeof(edges)) == 0 &&
+             arrays_equal(mesh->mid_x, loaded->mid_x, 9) && arrays_equal(mesh->mid_y, loaded->mid_y, 9) &&
+             arrays_equal(mesh->mid_z, loaded->mid_z, 9) && arrays_equal(mesh->normal_x, loaded->normal_x, 9) &&
+             arrays_equal(mesh->normal_y, loaded->normal_y, 9) && arrays_equal(mesh->normal_z, loaded->normal_z, 9) &&
+             loaded->bound_radius == mesh->bound_radius &&
+             ((size_t)loaded->px % 16) == 0 && ((size_t)loaded->mid_x % 16) == 0;
+    check(ok, "mesh_save/mesh_load round-trip positions, edges and edge cache");
+
+    // Loaded meshes stay writable (the file is not modified) and light like the original
+    if (loaded) {
+        vec3f_t moved[7];
+        for (int i = 0; i < 7; i++) moved[i] = vec3f_make(verts[i].x + 1.0f, verts[i].y, verts[i].z);
+        mesh_set_positions(loaded, moved);
+        mesh_t* again = mesh_load(filename);
+        ok = again && again->px[3] == mesh->px[3] && loaded->px[3] == moved[3].x;
+        mesh_destroy(again);
+    }
+    check(ok, "mesh_set_positions on a loaded mesh leaves the file untouched");
+
+    // Truncated or foreign files are rejected
+    FILE* file = fopen(filename, "rb");
+    char data[4096];
+    size_t size = file ? fread(data, 1, sizeof(data), file) : 0;
+    if (file) fclose(file);
+    file = fopen(filename, "wb");
+    if (file) {
+        fwrite(data, 1, size - 4, file);
+        fclose(file);
+    }
+    mesh_t* truncated = mesh_load(filename);
+    data[0] = 'X';
+    file = fopen(filename, "wb");
+    if (file) {
+        fwrite(data, 1, size, file);
+        fclose(file);
+    }
+    mesh_t* foreign = mesh_load(filename);
+    check(size > 0 && !truncated && !foreign && !mesh_load("no_such_mesh.t3m"),
+          "mesh_load rejects truncated, foreign and missing files");
+
+    remove(filename);
+    mesh_destroy(truncated);
+    mesh_destroy(foreign);
+    mesh_destroy(loaded);
+    mesh_destroy(mesh);
+}
+
+// Unit cube corners and faces shared by the importer tests (1-based like OBJ)
+static const float cube_corners[8][3] = {
+    {-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}
+};
+static const int cube_faces[6][4] = {
+    {1, 2, 3, 4}, {5, 8, 7, 6}, {1, 5, 6, 2}, {2, 6, 7, 3}, {3, 7, 8, 4}, {5, 1, 4, 8}
+};
+
+// The 12 cube edges, each once, and the 8 corners in order
+static int is_cube_mesh(const mesh_t* mesh) {
+    if (!mesh || mesh->vert_count != 8 || mesh->edge_count != 12) return 0;
+    for (int v = 0; v < 8; v++) {
+        if (mesh->px[v] != cube_corners[v][0] || mesh->py[v] != cube_corners[v][1] || mesh->pz[v] != cube_corners[v][2]) return 0;
+    }
+    for (int e = 0; e < 12; e++) {
+        int a = mesh->edges[e][0], b = mesh->edges[e][1];
+        int diff = 0;
+        for (int k = 0; k < 3; k++) diff += cube_corners[a][k] != cube_corners[b][k];
+        if (diff != 1) return 0;
+        for (int f = 0; f < e; f++) {
+            if (mesh->edges[f][0] == a && mesh->edges[f][1] == b) return 0;
+        }
+    }
+    return 1;
+}
+
+static void put_be32(FILE* file, const void* value) {
+    unsigned char raw[4];
+    memcpy(raw, value, 4);
+    uint16_t probe = 1;
+    if (*(unsigned char*)&probe == 1) {
+        unsigned char t = raw[0]; raw[0] = raw[3]; raw[3] = t;
+        t = raw[1]; raw[1] = raw[2]; raw[2] = t;
+    }
+    fwrite(raw, 1, 4, file);
+}
+
+// Cube as PLY: an extra per-vertex property and an extra element to skip
+static void write_cube_ply(const char* filename, const char* format) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) return;
+    fprintf(file, "ply\nformat %s 1.0\ncomment test cube\nelement vertex 8\nproperty float x\n"
+                  "property float y\nproperty float z\nproperty uchar flag\nelement face 6\n"
+                  "property list uchar int vertex_indices\nelement material 1\nproperty list uchar float rgb\n"
+                  "end_header\n", format);
+    int ascii = strcmp(format, "ascii") == 0, big = strcmp(format, "binary_big_endian") == 0;
+    unsigned char flag = 7, four = 4, three = 3;
+    float rgb[3] = { 0.5f, 0.25f, 1.0f };
+    for (int v = 0; v < 8; v++) {
+        if (ascii) {
+            fprintf(file, "%g %g %g 7\n", cube_corners[v][0], cube_corners[v][1], cube_corners[v][2]);
+            continue;
+        }
+        for (int k = 0; k < 3; k++) {
+            if (big) put_be32(file, &cube_corners[v][k]);
+            else fwrite(&cube_corners[v][k], 4, 1, file);
+        }
+        fwrite(&flag, 1, 1, file);
+    }
+    for (int f = 0; f < 6; f++) {
+        if (ascii) {
+            fprintf(file, "4 %d %d %d %d\n", cube_faces[f][0] - 1, cube_faces[f][1] - 1, cube_faces[f][2] - 1, cube_faces[f][3] - 1);
+            continue;
+        }
+        fwrite(&four, 1, 1, file);
+        for (int k = 0; k < 4; k++) {
+            int32_t index = cube_faces[f][k] - 1;
+            if (big) put_be32(file, &index);
+            else fwrite(&index, 4, 1, file);
+        }
+    }
+    if (ascii) {
+        fprintf(file, "3 0.5 0.25 1\n");
+    } else {
+        fwrite(&three, 1, 1, file);
+        for (int k = 0; k < 3; k++) {
+            if (big) put_be32(file, &rgb[k]);
+            else fwrite(&rgb[k], 4, 1, file);
+        }
+    }
+    fclose(file);
+}
+
+static void test_mesh_import(void) {
+    // OBJ with comments, normals, CRLF, v/vt/vn tokens and negative indices
+    FILE* file = fopen("test_import.obj", "wb");
+    if (file) {
+        fprintf(file, "# cube\r\nvn 0 0 1\r\n");
+        for (int v = 0; v < 8; v++) fprintf(file, "v %g %g %g\r\n", cube_corners[v][0], cube_corners[v][1], cube_corners[v][2]);
+        fprintf(file, "f 1/1/1 2/2/1 3//1 4\r\n");
+        for (int f = 1; f < 6; f++) {
+            fprintf(file, "f %d %d %d %d\r\n", cube_faces[f][0] - 9, cube_faces[f][1] - 9, cube_faces[f][2] - 9, cube_faces[f][3] - 9);
+        }
+        fprintf(file, "l 1 2 3\r\n");
+        fclose(file);
+    }
+    mesh_t* obj = mesh_import("test_import.obj");
+    check(is_cube_mesh(obj), "mesh_import reads OBJ faces and polylines into unique edges");
+
+    const char* formats[3] = { "ascii", "binary_little_endian", "binary_big_endian" };
+    int ply_ok = 1;
+    for (int i = 0; i < 3; i++) {
+        write_cube_ply("test_import.ply", formats[i]);
+        mesh_t* ply = mesh_import("test_import.ply");
+        if (!is_cube_mesh(ply)) ply_ok = 0;
+        mesh_destroy(ply);
+    }
+    check(ply_ok, "mesh_import reads ASCII, little- and big-endian PLY");
+
+    // Header vertex counts whose total no longer fits an int index
+    file = fopen("test_import.ply", "wb");
+    if (file) {
+        fprintf(file, "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\n"
+                      "element vertex 2147483647\nproperty float x\nend_header\n0\n1\n");
+        fclose(file);
+    }
+    check(!mesh_import("test_import.ply"), "mesh_import rejects PLY vertex counts beyond INT_MAX");
+
+    // A grid larger than several read chunks: lines straddle chunk boundaries
+    const int side = 150;
+    file = fopen("test_import.obj", "wb");
+    if (file) {
+        for (int y = 0; y < side; y++) {
+            for (int x = 0; x < side; x++) fprintf(file, "v %d.125 %d.5 0.000001\n", x, y);
+        }
+        for (int y = 0; y + 1 < side; y++) {
+            for (int x = 0; x + 1 < side; x++) {
+                int v = y * side + x + 1;
+                fprintf(file, "f %d %d %d %d\n", v, v + 1, v + side + 1, v + side);
+            }
+        }
+        fclose(file);
+    }
+    mesh_t* grid = mesh_import_cached("test_import.obj", "test_import.t3m");
+    int grid_ok = grid && grid->vert_count == side * side && grid->edge_count == 2 * side * (side - 1) &&
+                  grid->px[side * side - 1] == (side - 1) + 0.125f && grid->py[side * side - 1] == (side - 1) + 0.5f;
+    check(grid_ok, "mesh_import streams files larger than one chunk");
+
+    mesh_t* cached = mesh_import_cached("test_import.obj", "test_import.t3m");
+    check(cached && cached->storage && grid && cached->edge_count == grid->edge_count &&
+          memcmp(cached->edges, grid->edges, grid->edge_count * sizeof(*grid->edges)) == 0,
+          "mesh_import_cached reloads the binary cache");
+
+    // Same size, rewritten within the same second: the old cache must not be used
+    file = fopen("test_import.obj", "wb");
+    if (file) {
+        fprintf(file, "v 0.250 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+        fclose(file);
+    }
+    mesh_t* first = mesh_import_cached("test_import.obj", "test_import.t3m");
+    file = fopen("test_import.obj", "wb");
+    if (file) {
+        fprintf(file, "v 0.750 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+        fclose(file);
+    }
+    mesh_t* edited = mesh_import_cached("test_import.obj", "test_import.t3m");
+    mesh_t* reloaded = mesh_import_cached("test_import.obj", "test_import.t3m");
+    check(first && edited && reloaded && first->px[0] == 0.25f && edited->px[0] == 0.75f && !edited->storage &&
+          reloaded->storage && reloaded->px[0] == 0.75f,
+          "mesh_import_cached re-imports a source rewritten at the same size");
+    mesh_destroy(first);
+    mesh_destroy(edited);
+    mesh_destroy(reloaded);
+
+    file = fopen("test_import.obj", "wb");
+    if (file) {
+        fprintf(file, "v 0 0 0\nv 1 0 0\nf 1 2 3\n");
+        fclose(file);
+    }
+    check(!mesh_import("test_import.obj") && !mesh_import("missing.obj") && !mesh_import("test_mesh.txt"),
+          "mesh_import rejects bad indices, missing files and unknown formats");
+
+    remove("test_import.obj");
+    remove("test_import.ply");
+    remove("test_import.t3m");
+    mesh_destroy(obj);
+    mesh_destroy(grid);
+    mesh_destroy(cached);
+}
+
+// Edges in range, no self-loops or repeats, and every vertex of the given degrees
+static int geometry_well_formed(const geometry_t* g, int min_degree, int max_degree) {
+    if (!g) return 0;
+    unsigned char* seen = calloc((size_t)g->vert_count * g->vert_count, 1);
+    int* degree = calloc(g->vert_count, sizeof(int));
+    int ok = seen && degree;
+    for (int e = 0; ok && e < g->edge_count; e++) {
+        int a = g->edges[e][0], b = g->edges[e][1];
+        ok = a >= 0 && b >= 0 && a < g->vert_count && b < g->vert_count && a != b &&
+             !seen[(size_t)a * g->vert_count + b];
+        if (!ok) break;
+        seen[(size_t)a * g->vert_count + b] = seen[(size_t)b * g->vert_count + a] = 1;
+        degree[a]++;
+        degree[b]++;
+    }
+    for (int v = 0; ok && v < g->vert_count; v++) ok = degree[v] >= min_degree && degree[v] <= max_degree;
+    free(seen);
+    free(degree);
+    return ok;
+}
+
+static void test_geometry(void) {
+    int counts_ok = 1, unit_ok = 1;
+    for (int level = 0; level <= 3; level++) {
+        geometry_t* sphere = geometry_icosphere(level);
+        int faces = 20 << (2 * level);
+        counts_ok &= sphere && sphere->vert_count == faces / 2 + 2 && sphere->edge_count == faces * 3 / 2 &&
+                     sphere->triangle_count == faces && geometry_well_formed(sphere, 5, 6);
+        for (int v = 0; sphere && v < sphere->vert_count; v++) {
+            vec3_t p = sphere->verts[v];
+            unit_ok &= nearly_equal(p.x * p.x + p.y * p.y + p.z * p.z, 1.0f);
+        }
+        geometry_destroy(sphere);
+    }
+    check(counts_ok, "geometry_icosphere has 10*4^n+2 vertices and unique edges of degree 5-6");
+    check(unit_ok, "geometry_icosphere vertices lie on the unit sphere");
+
+    geometry_t* ball = geometry_truncated_icosphere(0);
+    int ball_ok = ball && ball->vert_count == 60 && ball->edge_count == 90 && geometry_well_formed(ball, 3, 3);
+    for (int e = 0; ball_ok && e < ball->edge_count; e++) {
+        vec3_t a = ball->verts[ball->edges[e][0]], b = ball->verts[ball->edges[e][1]];
+        vec3_t a0 = ball->verts[ball->edges[0][0]], b0 = ball->verts[ball->edges[0][1]];
+        float len = sqrtf((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+        float len0 = sqrtf((a0.x - b0.x) * (a0.x - b0.x) + (a0.y - b0.y) * (a0.y - b0.y) + (a0.z - b0.z) * (a0.z - b0.z));
+        ball_ok = fabsf(len - len0) < 1e-5f;
+    }
+    check(ball_ok, "geometry_truncated_icosphere(0) is the soccer ball: 60 vertices, 90 equal edges");
+
+    geometry_t* cube = geometry_cube();
+    geometry_t* tetra = geometry_tetrahedron();
+    geometry_t* truncated_tetra = geometry_truncate(tetra, 1.0f / 3.0f);
+    check(geometry_well_formed(cube, 3, 3) && cube->edge_count == 12 && geometry_well_formed(tetra, 3, 3) &&
+          tetra->edge_count == 6 && geometry_well_formed(truncated_tetra, 3, 3) &&
+          truncated_tetra->vert_count == 12 && truncated_tetra->edge_count == 18 &&
+          !geometry_truncate(cube, 0.25f) && !geometry_truncate(tetra, 0.5f),
+          "geometry_cube, geometry_tetrahedron and geometry_truncate build closed solids");
+
+    geometry_t* grid = geometry_grid(3, 2, 0.5f);
+    check(geometry_well_formed(grid, 2, 4) && grid->vert_count == 12 && grid->edge_count == 17 &&
+          grid->verts[0].x == -0.75f && grid->verts[0].y == -0.5f && grid->verts[11].x == 0.75f,
+          "geometry_grid spans columns x rows cells centred on the origin");
+
+    // Memoized LOD chain: same solids as the direct builds, coarser levels a prefix
+    const geometry_t* level3 = geometry_icosphere_cached(3);
+    const geometry_t* level2 = geometry_icosphere_cached(2);
+    geometry_t* direct = geometry_icosphere(3);
+    int lod_ok = level3 && level2 && direct && level3->vert_count == direct->vert_count &&
+                 level3->edge_count == direct->edge_count &&
+                 memcmp(level3->verts, direct->verts, direct->vert_count * sizeof(vec3_t)) == 0 &&
+                 memcmp(level3->edges, direct->edges, direct->edge_count * sizeof(*direct->edges)) == 0 &&
+                 memcmp(level3->verts, level2->verts, level2->vert_count * sizeof(vec3_t)) == 0;
+    check(lod_ok, "geometry_icosphere_cached matches geometry_icosphere and nests LOD levels");
+    check(geometry_icosphere_cached(3) == level3 && geometry_truncated_icosphere_cached(1) == geometry_truncated_icosphere_cached(1) &&
+          geometry_grid_cached(4, 4, 1.0f) == geometry_grid_cached(4, 4, 1.0f) &&
+          geometry_grid_cached(4, 4, 1.0f) != geometry_grid_cached(4, 4, 2.0f),
+          "geometry caches return one shared solid per parameter set");
+    check(!geometry_icosphere(-1) && !geometry_icosphere(GEOMETRY_MAX_SUBDIVISIONS + 1) &&
+          !geometry_icosphere_cached(GEOMETRY_MAX_SUBDIVISIONS + 1) && !geometry_grid(-1, 2, 1.0f),
+          "geometry generators reject out-of-range parameters");
+    geometry_cache_clear();
+
+    geometry_destroy(ball);
+    geometry_destroy(cube);
+    geometry_destroy(tetra);
+    geometry_destroy(truncated_tetra);
+    geometry_destroy(grid);
+    geometry_destroy(direct);
+}
+
+int main(void) {
+    test_mat4_kernels();
+    test_point_transforms();
+    test_quaternions();
+    test_look_rotation();
+    test_affine();
+    test_batch_lighting();
+    test_mesh_file();
+    test_mesh_import();
+    test_geometry();
+    test_line_falloff();
+    test_guard_band();
+    test_sparse_canvas();
+    test_blocked_canvas();
+    test_strip_render();
+    test_animation_tracks();
+    test_timelines();
+    test_arc_length();
+    test_sequence();
+    test_sequence_resume();
+    test_frame_ring();
+#ifdef TEST_FORK
+    test_frame_ring_crash();
+#endif
+
+    printf("%s: %d failure(s)\n", failures ? "FAILED" : "OK", failures);
+    return failures ? 1 : 0;
+}